@@ -0,0 +1,50 @@
+#ifndef ALLOC_COUNTER_H
+#define ALLOC_COUNTER_H
+
+#include <stdlib.h>
+#include <new>
+
+// 堆分配计数，替换全局的operator new，按线程分别计数
+// 定义了全局的operator new/delete，每个程序只能在一个源文件中包含
+inline long long& threadAllocCount() {
+    static thread_local long long count = 0;
+    return count;
+}
+
+void* operator new(size_t size) {
+    threadAllocCount()++;
+    void* p = malloc(size ? size : 1);
+    if(! p)
+        throw std::bad_alloc();
+    return p;
+}
+void* operator new[](size_t size) {
+    return operator new(size);
+}
+void* operator new(size_t size, const std::nothrow_t&) noexcept {
+    threadAllocCount()++;
+    return malloc(size ? size : 1);
+}
+void* operator new[](size_t size, const std::nothrow_t& tag) noexcept {
+    return operator new(size, tag);
+}
+void operator delete(void* p) noexcept {
+    free(p);
+}
+void operator delete[](void* p) noexcept {
+    free(p);
+}
+void operator delete(void* p, size_t) noexcept {
+    free(p);
+}
+void operator delete[](void* p, size_t) noexcept {
+    free(p);
+}
+void operator delete(void* p, const std::nothrow_t&) noexcept {
+    free(p);
+}
+void operator delete[](void* p, const std::nothrow_t&) noexcept {
+    free(p);
+}
+
+#endif
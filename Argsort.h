@@ -0,0 +1,73 @@
+#ifndef ARGSORT_H
+#define ARGSORT_H
+
+#include <stdint.h>
+#include <string.h>
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+#ifndef ARGSORT_RADIX_MIN
+#define ARGSORT_RADIX_MIN 2048 // 规模不小于该值时使用基数排序，否则按（键，下标）比较排序，两者结果相同
+#endif
+
+// double映射为保序的64位无符号整数：非负数置符号位，负数全部取反；-0.0与0.0视为相等
+inline uint64_t orderedKey(double x) {
+    if(x == 0.0)
+        x = 0.0;
+    uint64_t bits;
+    memcpy(&bits, &x, sizeof(bits));
+    return (bits >> 63) ? ~bits : bits | 0x8000000000000000ull;
+}
+
+// 按键升序排列下标0 ~ n-1，写入rank；键相同时下标小的在前（稳定），键不能为NaN
+// 基数排序每趟8位，由低到高共8趟，所有键在该位段相同时跳过该趟
+// 缓冲区为线程局部并跨调用复用
+inline void argsort(const double* keys, int n, int* rank) {
+    static thread_local std::vector<std::pair<double, int>> keyed; // 比较排序用
+    static thread_local std::vector<uint64_t> key, keyBuffer;
+    static thread_local std::vector<int> index, indexBuffer;
+    if(n < ARGSORT_RADIX_MIN) { // 规模较小时基数排序的计数开销占主导
+        keyed.resize(n);
+        for(int i=0; i<n; i++)
+            keyed[i] = std::make_pair(keys[i], i);
+        std::sort(keyed.begin(), keyed.end()); // 键相同时按下标，与稳定排序一致
+        for(int i=0; i<n; i++)
+            rank[i] = keyed[i].second;
+        return;
+    }
+
+    key.resize(n);
+    index.resize(n);
+    for(int i=0; i<n; i++) {
+        key[i] = orderedKey(keys[i]);
+        index[i] = i;
+    }
+    int count[8][256] = {}; // 各趟各取值的个数，一次遍历统计
+    for(int i=0; i<n; i++) {
+        for(int d=0; d<8; d++)
+            count[d][(key[i] >> (8 * d)) & 0xFF]++;
+    }
+    keyBuffer.resize(n);
+    indexBuffer.resize(n);
+    for(int d=0; d<8; d++) {
+        int shift = 8 * d;
+        if(count[d][(key[0] >> shift) & 0xFF] == n) // 该位段全部相同
+            continue;
+        int offset[256], sum = 0;
+        for(int v=0; v<256; v++) {
+            offset[v] = sum;
+            sum += count[d][v];
+        }
+        for(int i=0; i<n; i++) {
+            int p = offset[(key[i] >> shift) & 0xFF]++;
+            keyBuffer[p] = key[i];
+            indexBuffer[p] = index[i];
+        }
+        key.swap(keyBuffer);
+        index.swap(indexBuffer);
+    }
+    memcpy(rank, index.data(), n * sizeof(int));
+}
+
+#endif
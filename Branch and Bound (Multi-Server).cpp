@@ -0,0 +1,161 @@
+#include <iostream>
+#include <fstream>
+#include <assert.h>
+#include <vector>
+#include <string.h>
+#include <algorithm>
+#include <math.h>
+#include <time.h>
+#include "MultiServer.h"
+#include "SweepRunner.h"
+#include "BranchAndBound.h"
+using namespace std;
+
+#define W 5000000.0 // 信道带宽（Hz）
+#define G0 -40 // 路径损耗常数（dB）
+#define THETA 4 // 路径损耗指数
+#define D0 1 // 参考距离（m）
+#define D 100 // 传输距离（m）
+#define N0 -174 // 噪声功率谱密度（dB * m / Hz）
+
+#define POWER 5.0 // 发射功率（mW）
+
+string serverFile = "./Servers.txt"; // 服务器描述文件，由命令行参数指定
+string instanceRoot = "./TestInstances"; // 实例目录，由命令行参数指定
+
+// 由发射功率计算任务传输速率
+double R(double power) {
+    return W * log(1 + 1.0E-12 * power / 3.981071705534985E-18 / W) / 0.6931471805599453;
+}
+
+class Task {
+    public:
+        int id;
+        double dataSize, cyclePerBit;
+
+        Task(int id, double dataSize, double cyclePerBit) {
+            this->id = id;
+            this->dataSize = dataSize;
+            this->cyclePerBit = cyclePerBit;
+        }
+};
+
+class Server {
+    public:
+        int id;
+        double frequency; // CPU频率（Hz）
+
+        Server(int id, double frequency) {
+            this->id = id;
+            this->frequency = frequency;
+        }
+};
+
+// 读取Instance文件，格式：id - dataSize - cyclePerBit
+vector<Task> readInstanceFile(string fileDir) {
+    vector<Task> taskList;
+    ifstream fileIn;
+    fileIn.open(fileDir);
+    assert(fileIn); // 已打开
+
+    int lineNum; fileIn >> lineNum;
+    for(int i=0; i<lineNum; i++) {
+        int id_t; double data_t, cycle_t;
+        fileIn >> id_t >> data_t >> cycle_t;
+        taskList.emplace_back( Task(id_t, data_t, cycle_t) );
+    }
+
+    fileIn.close();
+    return taskList;
+}
+
+// 读取服务器描述文件，格式：首行为服务器数，之后每行 id - frequency
+vector<Server> readServerFile(string fileDir) {
+    vector<Server> serverList;
+    ifstream fileIn;
+    fileIn.open(fileDir);
+    assert(fileIn); // 已打开
+
+    int lineNum; fileIn >> lineNum;
+    for(int i=0; i<lineNum; i++) {
+        int id_t; double freq_t;
+        fileIn >> id_t >> freq_t;
+        serverList.emplace_back( Server(id_t, freq_t) );
+    }
+
+    fileIn.close();
+    return serverList;
+}
+
+// 单次运行，返回记录行
+string runInstance(const SweepJob& job, const vector<Server>& serverList) {
+    string resultReport = "";
+
+    // 读取任务序列
+    vector<Task> taskList = readInstanceFile(instanceRoot + "/" + job.taskNum + "/" + job.taskNum + "_" + job.instanceId + ".txt");
+    MultiServerEvaluator evaluator;
+    evaluator.build(taskList, R(POWER), serverList); // 预计算传输时间和各服务器上的执行时间
+
+    // 开始计时
+    struct timeval startTime;
+    mingw_gettimeofday(&startTime, NULL);
+
+    // 分支定界
+    BranchAndBound solver;
+    double makespan = solver.solve(evaluator);
+    assert(fabs(evaluator.makespan(solver.bestOrder.data(), solver.bestServer.data(), taskList.size()) - makespan) <= 1.0E-9 * makespan);
+
+    // 停止计时
+    struct timeval endTime;
+    mingw_gettimeofday(&endTime, NULL);
+    // 计算运行时间
+    double duration = (endTime.tv_sec - startTime.tv_sec)*1000.0 + (endTime.tv_usec - startTime.tv_usec)/1000.0;
+
+    // 记录信息
+    resultReport += job.taskNum + "\t"; // 任务数量
+    resultReport += job.instanceId + '\t'; // 测试实例编号
+    resultReport += to_string(job.repeat) + "\t"; // 重复测试次数
+    resultReport += to_string(makespan) + "\t"; // 求得的makespan，未达到目标差距时只是上界，未必最优
+    resultReport += to_string(duration) + "\t"; // 运行时间
+    resultReport += to_string(solver.lowerBound) + "\t"; // 全局下界
+    resultReport += to_string(makespan / solver.lowerBound - 1.0) + "\t"; // 与下界的相对差距
+    resultReport += to_string(solver.nodes.load()) + "\t"; // 展开的节点数
+    resultReport += to_string(solver.initialMakespan) + "\t"; // 贪心初始解的makespan
+    resultReport += string(solver.proven ? "gap" : solver.timedOut ? "time" : "queue") + "\t"; // 停止原因：已达目标差距、时间上限，或队列淘汰节点后搜索结束
+    resultReport += "\n";
+    return resultReport;
+}
+
+int main(int argc, char* argv[]) {
+    // 可选参数：服务器描述文件，默认为./Servers.txt；实例目录，默认为./TestInstances
+    if(argc > 1)
+        serverFile = argv[1];
+    if(argc > 2)
+        instanceRoot = argv[2];
+    vector<Server> serverList = readServerFile(serverFile);
+
+// 实例测试
+vector<string> iTN {"20", "30", "40", "50"}; // 实例任务数量
+vector<string> iID {"0", "1", "2", "3", "4", "5", "6", "7", "8", "9"}; // 实例编号
+
+    // 逐个运行实例，每个实例的搜索由全部线程共同完成；不重复测试
+    string resultReport = "";
+    vector<string> presentTN = presentTaskNums(instanceRoot, iTN, iID);
+    for(auto it_n = presentTN.begin(); it_n != presentTN.end(); it_n++) {
+        for(auto it_id = iID.begin(); it_id != iID.end(); it_id++) {
+            resultReport += runInstance(SweepJob {*it_n, *it_id, 0, 0}, serverList);
+            cout << "Completed Instance " + *it_n + "_" + *it_id + ".\n";
+        }
+    }
+
+    // 写入输出文件，非默认服务器文件时文件名注明文件（不含扩展名）
+    ofstream fileOut;
+    if(argc > 1)
+        fileOut.open("./Test Result - Branch and Bound (" + stemName(serverFile) + ").txt");
+    else
+        fileOut.open("./Test Result - Branch and Bound (Multi-Server).txt");
+    fileOut << resultReport;
+    fileOut.close();
+
+    return 0;
+}
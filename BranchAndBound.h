@@ -0,0 +1,523 @@
+#ifndef BRANCH_AND_BOUND_H
+#define BRANCH_AND_BOUND_H
+
+#include <assert.h>
+#include <math.h>
+#include <stdint.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <iterator>
+#include <mutex>
+#include <set>
+#include <vector>
+#include "MultiServer.h"
+#include "Scheduler.h"
+
+#ifndef BNB_GAP
+#define BNB_GAP 1.0E-4 // 目标相对差距：下界不小于 现有最优解 * (1 - BNB_GAP) 时剪枝
+#endif
+#ifndef BNB_TIME_LIMIT_MS
+#define BNB_TIME_LIMIT_MS 2000 // 单个实例的时间上限（毫秒），到达时返回现有最优解和全局下界
+#endif
+#ifndef BNB_QUEUE_LIMIT
+#define BNB_QUEUE_LIMIT 200000 // 开放节点数上限，超过后淘汰下界最大的节点，其下界计入全局下界
+#endif
+#ifndef BNB_MAX_SERVERS
+#define BNB_MAX_SERVERS 8 // 支持的最多服务器数
+#endif
+#define BNB_MAX_TASKS 64 // 已安排的任务以64位掩码记录
+
+// 多服务器卸载的分支定界
+// 节点为已确定的前缀：依次传输的任务及其服务器，携带前缀处理完后的t_ready和各服务器的t_complete
+// 剩余任务集合S的下界取以下各项的最大值：
+//   信道：t_ready + Σ传输时间(S)，最后到达的任务至少还需在某台服务器上执行min计算量(S)
+//   单个任务：每个任务最早在t_ready + 传输时间到达，在最快完成它的服务器上执行
+//   容量：各服务器从max(t_complete_m, t_ready + min传输时间(S))起满负荷执行，放松为可抢占的同类机
+//   流水车间松弛：全部服务器合并为频率ΣF的一台，各服务器剩余的前缀计算量作为首个任务，Johnson规则给出最优值
+// 每个子节点还以剩余任务的贪心补全（Johnson顺序 + 最早完成分配）得到一个完整调度，优于现有最优解时经插入邻域局部搜索后提交
+// 节点按下界最优先出队：一半的展开用于按下界逐个展开，使全局下界上升；另一半沿补全最好的子节点下潜到叶子，用于改进现有最优解
+// 兄弟节点入队，全部线程共享队列和现有最优解；队列满时淘汰下界最大的节点
+// 未达到目标差距（proven为false）时bestMakespan只是上界，评价元启发式时应与lowerBound比较
+class BranchAndBound {
+    public:
+        std::vector<int> bestOrder; // 找到的最好解的任务序列
+        std::vector<int> bestServer; // 最好解中各任务分配的服务器，与bestOrder对应
+        double bestMakespan;
+        double initialMakespan; // 初始解：最早完成分配 + 插入邻域局部搜索
+        double lowerBound; // 全局下界，达到目标差距时不小于 bestMakespan * (1 - BNB_GAP)
+        bool timedOut; // 是否因时间上限停止
+        bool proven; // 全局下界是否已在目标差距内
+        std::atomic<long long> nodes; // 展开的节点数
+
+        BranchAndBound() {
+            this->bestMakespan = HUGE_VAL;
+            this->initialMakespan = HUGE_VAL;
+            this->lowerBound = 0.0;
+            this->timedOut = false;
+            this->proven = false;
+            this->nodes.store(0);
+        }
+
+        // 求解evaluator对应实例，返回找到的最好makespan，proven为true时与最优值的相对差距不超过BNB_GAP
+        double solve(const MultiServerEvaluator& evaluator) {
+            this->evaluator = &evaluator;
+            n = evaluator.size();
+            M = evaluator.serverNum();
+            assert(n <= BNB_MAX_TASKS && M <= BNB_MAX_SERVERS);
+            prepare();
+            nodes.store(0);
+            timedOut = false;
+            trail.clear();
+            open.clear();
+            startTime = std::chrono::steady_clock::now();
+            stopping.store(false);
+            active.store(0);
+            abandonedBound.store(HUGE_VAL);
+            diveNodes.store(0);
+            bestFirstNodes.store(0);
+
+            // 初始解：从流水车间松弛的Johnson顺序出发，对任务序列做插入邻域的局部搜索
+            std::vector<int> order = relaxedOrder, server(n);
+            improve(order, server);
+            bestOrder = order;
+            bestServer = server;
+            bestMakespan = initialMakespan = evaluator.makespan(order.data(), server.data(), n);
+            incumbent.store(bestMakespan);
+
+            Node root;
+            root.ready = 0.0;
+            std::fill(root.complete, root.complete + BNB_MAX_SERVERS, 0.0);
+            root.used = 0;
+            root.depth = 0;
+            root.trail = -1;
+            root.finish = 0.0;
+            root.bound = bound(root);
+            root.upper = completion(root);
+            if(n > 0)
+                open.insert(root);
+
+            scheduler().parallelFor(scheduler().size(), [&](int begin, int end) {
+                for(int w = begin; w < end; w++)
+                    work();
+            });
+
+            timedOut = stopping.load();
+
+            // 全局下界：未展开的节点、被淘汰的节点、剪去的节点和现有最优解中的最小值
+            lowerBound = incumbent.load();
+            if(! open.empty() && open.begin()->bound < lowerBound)
+                lowerBound = open.begin()->bound;
+            if(abandonedBound.load() < lowerBound)
+                lowerBound = abandonedBound.load();
+            if(prunedBound.load() < lowerBound)
+                lowerBound = prunedBound.load();
+            proven = lowerBound >= bestMakespan * (1.0 - BNB_GAP);
+            return bestMakespan;
+        }
+
+    private:
+        struct Node {
+            double bound; // 下界，不小于父节点的下界
+            double ready; // 前缀传输完的时刻
+            double complete[BNB_MAX_SERVERS]; // 各服务器执行完前缀中分给它的任务的时刻
+            double finish; // 最后安排的任务的完成时刻，下界相同时优先完成早的
+            double upper; // 剩余任务贪心补全后的makespan，下潜时优先补全好的子节点
+            uint64_t used; // 已安排的任务
+            int depth; // 前缀长度
+            int trail; // 最后一步在trail中的下标，根节点为-1
+        };
+        // 队列顺序：下界小的先出队，相同时深的、完成早的先出队，最后按trail下标区分
+        struct NodeBefore {
+            bool operator()(const Node& a, const Node& b) const {
+                if(a.bound != b.bound)
+                    return a.bound < b.bound;
+                if(a.depth != b.depth)
+                    return a.depth > b.depth;
+                if(a.finish != b.finish)
+                    return a.finish < b.finish;
+                return a.trail < b.trail;
+            }
+        };
+        // 前缀的一步，由parent链接成前缀
+        struct Step {
+            int parent;
+            uint8_t task, server;
+        };
+
+        const MultiServerEvaluator* evaluator;
+        int n, M;
+        const double* trans;
+        std::vector<double> relaxedDispose; // 合并服务器上的执行时间 cycles / ΣF
+        std::vector<int> relaxedOrder; // 流水车间松弛的Johnson顺序
+        double totalTrans, totalFrequency;
+
+        std::mutex openMutex; // 保护open和trail
+        std::condition_variable openChanged; // 有节点入队、展开结束或停止时通知空闲的线程
+        std::set<Node, NodeBefore> open; // 开放节点，首个下界最小，末个下界最大
+        std::vector<Step> trail; // 入队和下潜经过的节点的最后一步
+        std::mutex bestMutex; // 保护bestOrder、bestServer和bestMakespan
+        std::atomic<double> incumbent; // 现有最优解，各线程共享，只减小
+        std::atomic<double> prunedBound; // 剪去的节点中最小的下界
+        std::atomic<double> abandonedBound; // 因超时放弃的节点中最小的下界
+        std::atomic<bool> stopping;
+        std::atomic<int> active; // 正在展开节点的线程数
+        std::atomic<long long> diveNodes, bestFirstNodes; // 下潜和按下界展开的节点数，各占一半
+        std::chrono::steady_clock::time_point startTime;
+
+        void prepare() {
+            trans = evaluator->t_trans.data();
+            totalTrans = 0.0;
+            for(int id=0; id<n; id++)
+                totalTrans += trans[id];
+            totalFrequency = 0.0;
+            for(int m=0; m<M; m++)
+                totalFrequency += evaluator->frequency[m];
+            relaxedDispose.resize(n);
+            for(int id=0; id<n; id++)
+                relaxedDispose[id] = evaluator->cycles[id] / totalFrequency;
+            // Johnson规则：传输时间不大于执行时间的按传输时间升序在前，其余按执行时间降序在后
+            relaxedOrder.resize(n);
+            for(int id=0; id<n; id++)
+                relaxedOrder[id] = id;
+            const std::vector<double>& a = evaluator->t_trans;
+            const std::vector<double>& b = relaxedDispose;
+            auto front = std::stable_partition(relaxedOrder.begin(), relaxedOrder.end(), [&](int x){ return a[x] <= b[x]; });
+            std::stable_sort(relaxedOrder.begin(), front, [&](int x, int y){ return a[x] < a[y]; });
+            std::stable_sort(front, relaxedOrder.end(), [&](int x, int y){ return b[x] > b[y]; });
+            prunedBound.store(HUGE_VAL);
+        }
+
+        // 对任务序列做插入邻域的首次改进局部搜索，服务器按assign()分配，返回makespan
+        double improve(std::vector<int>& order, std::vector<int>& server) const {
+            std::vector<int> candidate(n);
+            double current = assign(order, server);
+            for(bool improved = true; improved; ) {
+                improved = false;
+                for(int i=0; i<n && ! improved; i++) {
+                    for(int j=0; j<n && ! improved; j++) {
+                        if(j == i || j == i - 1)
+                            continue;
+                        candidate = order;
+                        if(j > i)
+                            std::rotate(candidate.begin() + i, candidate.begin() + i + 1, candidate.begin() + j + 1);
+                        else
+                            std::rotate(candidate.begin() + j, candidate.begin() + i, candidate.begin() + i + 1);
+                        double makespan = assign(candidate, server);
+                        if(makespan < current * (1.0 - 1.0E-12)) {
+                            order.swap(candidate);
+                            current = makespan;
+                            improved = true;
+                        }
+                    }
+                }
+            }
+            return assign(order, server);
+        }
+
+        // 剩余任务按Johnson顺序接在前缀之后，每个分给最早完成它的服务器，返回makespan
+        // order、server不为nullptr时写入补全的部分，即第depth ~ n-1个任务
+        double completion(const Node& node, int* order = nullptr, int* server = nullptr) const {
+            double ready = node.ready, complete[BNB_MAX_SERVERS], result = 0.0;
+            for(int m=0; m<M; m++) {
+                complete[m] = node.complete[m];
+                if(complete[m] > result)
+                    result = complete[m];
+            }
+            for(int k = 0, depth = node.depth; k < n; k++) {
+                int id = relaxedOrder[k], s = 0;
+                if(node.used >> id & 1)
+                    continue;
+                ready += trans[id];
+                for(int m=1; m<M; m++)
+                    if(finish(ready, complete[m], id, m) < finish(ready, complete[s], id, s))
+                        s = m;
+                complete[s] = finish(ready, complete[s], id, s);
+                if(complete[s] > result)
+                    result = complete[s];
+                if(order) {
+                    order[depth] = id;
+                    server[depth] = s;
+                    depth++;
+                }
+            }
+            return result;
+        }
+
+        // 按序列传输，每个任务分给最早完成它的服务器，返回makespan
+        double assign(const std::vector<int>& order, std::vector<int>& server) const {
+            double ready = 0.0, complete[BNB_MAX_SERVERS] = {0.0}, result = 0.0;
+            for(int k=0; k<n; k++) {
+                int id = order[k], s = 0;
+                ready += trans[id];
+                for(int m=1; m<M; m++)
+                    if(finish(ready, complete[m], id, m) < finish(ready, complete[s], id, s))
+                        s = m;
+                complete[s] = finish(ready, complete[s], id, s);
+                server[k] = s;
+                if(complete[s] > result)
+                    result = complete[s];
+            }
+            return result;
+        }
+
+        double finish(double ready, double complete, int id, int m) const {
+            return (ready > complete ? ready : complete) + evaluator->dispose(id, m);
+        }
+
+        static void atomicMin(std::atomic<double>& target, double value) {
+            double current = target.load(std::memory_order_relaxed);
+            while(value < current && ! target.compare_exchange_weak(current, value, std::memory_order_relaxed)) {}
+        }
+
+        bool timeUp() const {
+            return BNB_TIME_LIMIT_MS > 0 &&
+                   std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - startTime).count() >= BNB_TIME_LIMIT_MS;
+        }
+
+        // 下界不小于该值的节点剪去
+        double threshold() const {
+            return incumbent.load(std::memory_order_relaxed) * (1.0 - BNB_GAP);
+        }
+
+        // 剪去节点，记录其下界
+        bool prune(const Node& node) {
+            if(node.bound < threshold())
+                return false;
+            atomicMin(prunedBound, node.bound);
+            return true;
+        }
+
+        double bound(const Node& node) const {
+            const double* cycles = evaluator->cycles.data();
+            const double* frequency = evaluator->frequency.data();
+            const double* complete = node.complete;
+            double result = 0.0;
+            for(int m=0; m<M; m++)
+                if(complete[m] > result)
+                    result = complete[m];
+            if(node.depth == n)
+                return result;
+
+            // 按Johnson顺序遍历剩余任务，同时累计其他各项所需的量
+            double backlog = 0.0; // 各服务器在t_ready之后剩余的前缀计算量
+            for(int m=0; m<M; m++)
+                if(complete[m] > node.ready)
+                    backlog += frequency[m] * (complete[m] - node.ready);
+            double relaxedReady = node.ready, relaxedComplete = node.ready + backlog / totalFrequency;
+            double minTrans = HUGE_VAL, minCycles = HUGE_VAL, restCycles = 0.0;
+            for(int k=0; k<n; k++) {
+                int id = relaxedOrder[k];
+                if(node.used >> id & 1)
+                    continue;
+                relaxedReady += trans[id];
+                relaxedComplete = (relaxedReady > relaxedComplete ? relaxedReady : relaxedComplete) + relaxedDispose[id];
+                if(trans[id] < minTrans)
+                    minTrans = trans[id];
+                if(cycles[id] < minCycles)
+                    minCycles = cycles[id];
+                restCycles += cycles[id];
+                double arrival = node.ready + trans[id], earliest = HUGE_VAL;
+                for(int m=0; m<M; m++) {
+                    double t = finish(arrival, complete[m], id, m);
+                    if(t < earliest)
+                        earliest = t;
+                }
+                if(earliest > result)
+                    result = earliest;
+            }
+            if(relaxedComplete > result)
+                result = relaxedComplete;
+
+            // 信道
+            double lastArrival = totalTrans, last = HUGE_VAL; // 剩余任务全部传输完的时刻
+            for(int m=0; m<M; m++) {
+                double t = (lastArrival > complete[m] ? lastArrival : complete[m]) + minCycles / frequency[m];
+                if(t < last)
+                    last = t;
+            }
+            if(last > result)
+                result = last;
+
+            // 容量：按可用时刻升序加入服务器，找到剩余计算量恰好完成的时刻
+            double available[BNB_MAX_SERVERS], speed[BNB_MAX_SERVERS];
+            for(int m=0; m<M; m++) {
+                double a = node.ready + minTrans;
+                double t = complete[m] > a ? complete[m] : a;
+                int k = m;
+                for(; k > 0 && available[k - 1] > t; k--) {
+                    available[k] = available[k - 1];
+                    speed[k] = speed[k - 1];
+                }
+                available[k] = t;
+                speed[k] = frequency[m];
+            }
+            double rest = restCycles, rate = 0.0;
+            for(int k=0; k<M; k++) {
+                rate += speed[k];
+                double span = k + 1 < M ? available[k + 1] - available[k] : HUGE_VAL;
+                if(rest <= rate * span) {
+                    double t = available[k] + rest / rate;
+                    if(t > result)
+                        result = t;
+                    break;
+                }
+                rest -= rate * span;
+            }
+            return result;
+        }
+
+        // 展开node，子节点以贪心补全提交完整调度，非叶子的子节点按下界过滤后放入children
+        void expand(const Node& node, std::vector<Node>& children, std::vector<Step>& steps) {
+            nodes.fetch_add(1, std::memory_order_relaxed);
+            children.clear();
+            steps.clear();
+            for(int id=0; id<n; id++) {
+                if(node.used >> id & 1)
+                    continue;
+                double ready = node.ready + trans[id];
+                for(int m=0; m<M; m++) {
+                    // 频率相同且完成时刻相同的服务器可互换，只展开第一台
+                    bool symmetric = false;
+                    for(int s=0; s<m && ! symmetric; s++)
+                        symmetric = evaluator->frequency[s] == evaluator->frequency[m] && node.complete[s] == node.complete[m];
+                    if(symmetric)
+                        continue;
+                    Node child = node;
+                    child.ready = ready;
+                    child.complete[m] = child.finish = finish(ready, node.complete[m], id, m);
+                    child.used |= (uint64_t)1 << id;
+                    child.depth++;
+                    child.upper = completion(child);
+                    Step step {node.trail, (uint8_t)id, (uint8_t)m};
+                    if(child.upper < incumbent.load(std::memory_order_relaxed))
+                        offer(child, step);
+                    if(child.depth == n)
+                        continue;
+                    child.bound = std::max(node.bound, bound(child));
+                    if(prune(child))
+                        continue;
+                    children.emplace_back(child);
+                    steps.emplace_back(step);
+                }
+            }
+        }
+
+        // node的贪心补全优于现有最优解：还原完整调度，再做插入邻域局部搜索，较好者优于现有最优解时记录
+        // step为node的最后一步，尚未记入trail
+        void offer(const Node& node, const Step& step) {
+            std::vector<int> order(n), server(n);
+            order[node.depth - 1] = step.task;
+            server[node.depth - 1] = step.server;
+            {
+                std::lock_guard<std::mutex> lock(openMutex);
+                for(int k = node.depth - 2, s = step.parent; k >= 0; k--, s = trail[s].parent) {
+                    order[k] = trail[s].task;
+                    server[k] = trail[s].server;
+                }
+            }
+            completion(node, order.data(), server.data());
+            double makespan = evaluator->makespan(order.data(), server.data(), n);
+            std::vector<int> improvedOrder = order, improvedServer(n);
+            double improved = improve(improvedOrder, improvedServer);
+            if(improved < makespan) {
+                order.swap(improvedOrder);
+                server.swap(improvedServer);
+                makespan = evaluator->makespan(order.data(), server.data(), n);
+            }
+            atomicMin(incumbent, makespan);
+            std::lock_guard<std::mutex> lock(bestMutex);
+            if(makespan < bestMakespan) {
+                bestMakespan = makespan;
+                bestOrder.swap(order);
+                bestServer.swap(server);
+            }
+        }
+
+        // 停止搜索，唤醒空闲的线程
+        void stop() {
+            {
+                std::lock_guard<std::mutex> lock(openMutex);
+                stopping.store(true);
+            }
+            openChanged.notify_all();
+        }
+
+        // 取出下界最小的节点；队列为空时等待其他线程入队，队列为空且没有线程在展开时返回false
+        bool pop(Node& node) {
+            std::unique_lock<std::mutex> lock(openMutex);
+            while(! stopping.load() && open.empty() && active.load() > 0)
+                openChanged.wait(lock);
+            if(stopping.load() || open.empty())
+                return false;
+            node = *open.begin();
+            open.erase(open.begin());
+            active.fetch_add(1);
+            return true;
+        }
+
+        // 展开结束，最后一个展开的线程结束且队列为空时唤醒等待的线程
+        void release() {
+            bool idle;
+            {
+                std::lock_guard<std::mutex> lock(openMutex);
+                idle = active.fetch_sub(1) == 1 && open.empty();
+            }
+            if(idle)
+                openChanged.notify_all();
+        }
+
+        // 子节点记入trail，除skip以外入队；超过容量时淘汰下界最大的节点
+        void push(std::vector<Node>& children, const std::vector<Step>& steps, int skip) {
+            {
+                std::lock_guard<std::mutex> lock(openMutex);
+                for(int k = 0; k < (int)children.size(); k++) {
+                    children[k].trail = trail.size();
+                    trail.emplace_back(steps[k]);
+                    if(k == skip)
+                        continue;
+                    open.insert(children[k]);
+                    if(open.size() > BNB_QUEUE_LIMIT) {
+                        auto worst = std::prev(open.end());
+                        atomicMin(abandonedBound, worst->bound);
+                        open.erase(worst);
+                    }
+                }
+            }
+            openChanged.notify_all();
+        }
+
+        // 每次出队后，下潜的展开数不多于按下界展开的数时沿补全最好的子节点下潜到叶子，否则只展开该节点
+        void work() {
+            std::vector<Node> children;
+            std::vector<Step> steps;
+            Node node;
+            while(pop(node)) {
+                bool dive = diveNodes.load(std::memory_order_relaxed) <= bestFirstNodes.load(std::memory_order_relaxed);
+                while(! prune(node)) {
+                    if(stopping.load(std::memory_order_relaxed) || timeUp()) {
+                        atomicMin(abandonedBound, node.bound);
+                        stop();
+                        break;
+                    }
+                    expand(node, children, steps);
+                    (dive ? diveNodes : bestFirstNodes).fetch_add(1, std::memory_order_relaxed);
+                    int next = -1;
+                    if(dive) {
+                        for(int k = 0; k < (int)children.size(); k++)
+                            if(next < 0 || children[k].upper < children[next].upper ||
+                               (children[k].upper == children[next].upper && children[k].bound < children[next].bound))
+                                next = k;
+                    }
+                    push(children, steps, next);
+                    if(next < 0)
+                        break;
+                    node = children[next];
+                }
+                release();
+            }
+        }
+};
+
+#endif
@@ -0,0 +1,50 @@
+#ifndef CHANNEL_H
+#define CHANNEL_H
+
+#include <stddef.h>
+#include <atomic>
+#include <vector>
+
+// 单生产者单消费者无锁环形队列，容量固定
+// 生产者只写tail，消费者只写head，两者各占一个缓存行
+template<class T>
+class SpscChannel {
+    public:
+        explicit SpscChannel(int capacity) {
+            size_t size = 1;
+            while(size < capacity)
+                size <<= 1;
+            buffer.resize(size);
+            mask = size - 1;
+            head.store(0);
+            tail.store(0);
+        }
+
+        // 由生产者调用，队列满时返回false
+        bool push(const T& value) {
+            size_t t = tail.load(std::memory_order_relaxed);
+            if(t - head.load(std::memory_order_acquire) > mask)
+                return false;
+            buffer[t & mask] = value;
+            tail.store(t + 1, std::memory_order_release);
+            return true;
+        }
+
+        // 由消费者调用，队列空时返回false
+        bool pop(T& value) {
+            size_t h = head.load(std::memory_order_relaxed);
+            if(h == tail.load(std::memory_order_acquire))
+                return false;
+            value = buffer[h & mask];
+            head.store(h + 1, std::memory_order_release);
+            return true;
+        }
+
+    private:
+        std::vector<T> buffer;
+        size_t mask;
+        alignas(64) std::atomic<size_t> head; // 消费者读取位置
+        alignas(64) std::atomic<size_t> tail; // 生产者写入位置
+};
+
+#endif
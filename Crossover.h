@@ -0,0 +1,269 @@
+#ifndef CROSSOVER_H
+#define CROSSOVER_H
+
+#include <assert.h>
+#include <ctype.h>
+#include <algorithm>
+#include <random>
+#include <vector>
+
+#ifndef CROSSOVER_TYPE
+#define CROSSOVER_TYPE 0 // 默认的交叉算子，取值见CrossoverType
+#endif
+
+// 排列交叉算子，均为O(n)
+// 父代a、b为任务id 0 ~ n-1的排列，子代写入调用者提供的child（不能与a、b重叠），只使用传入的随机数
+// 缓冲区为线程局部并跨调用复用，可作为子任务并行调用
+enum CrossoverType {
+    CROSSOVER_OX, // Davis顺序交叉：保留a的一段，其余位置按b的顺序填入
+    CROSSOVER_PMX, // 部分映射交叉
+    CROSSOVER_CX, // 循环交叉
+    CROSSOVER_ERX, // 边重组交叉
+    CROSSOVER_POSITION // 基于位置的交叉
+};
+
+inline const char* crossoverName(CrossoverType type) {
+    switch(type) {
+        case CROSSOVER_PMX: return "PMX";
+        case CROSSOVER_CX: return "CX";
+        case CROSSOVER_ERX: return "ERX";
+        case CROSSOVER_POSITION: return "POS";
+        default: return "OX";
+    }
+}
+
+// 由名称（不区分大小写）得到交叉算子，名称无效时返回false
+inline bool parseCrossoverType(const char* name, CrossoverType& type) {
+    const CrossoverType all[] = {CROSSOVER_OX, CROSSOVER_PMX, CROSSOVER_CX, CROSSOVER_ERX, CROSSOVER_POSITION};
+    for(int k=0; k<5; k++) {
+        const char* candidate = crossoverName(all[k]);
+        int i = 0;
+        while(name[i] && candidate[i] && toupper((unsigned char)name[i]) == candidate[i])
+            i++;
+        if(name[i] == 0 && candidate[i] == 0) {
+            type = all[k];
+            return true;
+        }
+    }
+    return false;
+}
+
+// 任务id集合，reset()为O(1)（换一个新的标记值），判断和加入为O(1)
+class MarkSet {
+    public:
+        MarkSet() {
+            this->stamp = 0;
+        }
+
+        void reset(int n) {
+            if(stamps.size() < n)
+                stamps.resize(n, 0);
+            if(++stamp == 0) { // 标记值回绕，全部清零
+                std::fill(stamps.begin(), stamps.end(), 0);
+                stamp = 1;
+            }
+        }
+        void insert(int id) {
+            stamps[id] = stamp;
+        }
+        bool contains(int id) const {
+            return stamps[id] == stamp;
+        }
+
+    private:
+        std::vector<unsigned> stamps;
+        unsigned stamp;
+};
+
+// 随机选择一段[start, end]，与原GA中的抽取方式相同
+template<class RngT>
+void randomSegment(int n, RngT& rng, int& start, int& end) {
+    std::uniform_int_distribution<int> rand_start(0, n - 1); // 随机选择起始下标
+    start = rand_start(rng);
+    std::uniform_int_distribution<int> rand_end(start, n - 1); // 随机选择结束下标
+    end = rand_end(rng);
+}
+
+// Davis顺序交叉：a[start, end]原位保留，b中不在该段的任务依次填入前start个位置和段后的位置
+template<class IndexT, class RngT>
+void crossoverOX(const IndexT* a, const IndexT* b, int n, IndexT* child, RngT& rng) {
+    static thread_local MarkSet gene;
+    int start, end;
+    randomSegment(n, rng, start, end);
+    gene.reset(n);
+    for(int i = start; i <= end; i++) {
+        gene.insert(a[i]);
+        child[i] = a[i];
+    }
+    int pos = 0;
+    for(int i=0; i<n; i++) {
+        if(gene.contains(b[i]))
+            continue;
+        if(pos == start) // 跳过选定段
+            pos = end + 1;
+        child[pos++] = b[i];
+    }
+    assert(pos == n || pos == start); // 选定段在末尾时停在段前
+}
+
+// 部分映射交叉：a[start, end]原位保留，b在段内被挤出的任务沿 段内位置 -> a的任务 -> 该任务在b中的位置 映射到段外
+// 映射链经过的段内位置互不相同，总代价O(n)
+template<class IndexT, class RngT>
+void crossoverPMX(const IndexT* a, const IndexT* b, int n, IndexT* child, RngT& rng) {
+    static thread_local MarkSet gene, filled;
+    static thread_local std::vector<int> positionInB;
+    int start, end;
+    randomSegment(n, rng, start, end);
+    positionInB.resize(n);
+    for(int i=0; i<n; i++)
+        positionInB[b[i]] = i;
+    gene.reset(n);
+    filled.reset(n); // 按位置
+    for(int i = start; i <= end; i++) {
+        gene.insert(a[i]);
+        child[i] = a[i];
+        filled.insert(i);
+    }
+    for(int i = start; i <= end; i++) {
+        if(gene.contains(b[i]))
+            continue;
+        int j = i;
+        do {
+            j = positionInB[a[j]];
+        } while(j >= start && j <= end);
+        child[j] = b[i];
+        filled.insert(j);
+    }
+    for(int i=0; i<n; i++) {
+        if(! filled.contains(i))
+            child[i] = b[i];
+    }
+}
+
+// 循环交叉：按a、b的位置对应关系分解为若干循环，奇数个循环取a，偶数个循环取b
+template<class IndexT, class RngT>
+void crossoverCX(const IndexT* a, const IndexT* b, int n, IndexT* child, RngT&) { // 确定性算子，随机数参数只为与其他算子一致
+    static thread_local MarkSet visited;
+    static thread_local std::vector<int> positionInA;
+    positionInA.resize(n);
+    for(int i=0; i<n; i++)
+        positionInA[a[i]] = i;
+    visited.reset(n); // 按位置
+    bool fromA = true;
+    for(int i=0; i<n; i++) {
+        if(visited.contains(i))
+            continue;
+        int j = i;
+        do {
+            visited.insert(j);
+            child[j] = fromA ? a[j] : b[j];
+            j = positionInA[b[j]];
+        } while(j != i);
+        fromA = ! fromA;
+    }
+}
+
+// 边重组交叉：每个任务的邻居为它在a、b中（首尾相接）的前后任务，至多4个
+// 从a[0]出发，每次走向剩余邻居最少的未访问邻居（相同时随机），没有未访问邻居时随机取一个未访问任务
+template<class IndexT, class RngT>
+void crossoverERX(const IndexT* a, const IndexT* b, int n, IndexT* child, RngT& rng) {
+    static thread_local std::vector<int> neighbor, degree, unvisited, positionInUnvisited;
+    neighbor.resize(4 * n);
+    degree.assign(n, 0);
+    auto addEdge = [&](int u, int v) {
+        for(int k = 0; k < degree[u]; k++)
+            if(neighbor[4 * u + k] == v)
+                return;
+        neighbor[4 * u + degree[u]++] = v;
+    };
+    if(n > 1) {
+        for(int i=0; i<n; i++) {
+            int next = (i + 1) % n;
+            addEdge(a[i], a[next]);
+            addEdge(a[next], a[i]);
+            addEdge(b[i], b[next]);
+            addEdge(b[next], b[i]);
+        }
+    }
+    unvisited.resize(n);
+    positionInUnvisited.resize(n);
+    for(int i=0; i<n; i++) {
+        unvisited[i] = i;
+        positionInUnvisited[i] = i;
+    }
+    int remaining = n;
+    int current = a[0];
+    for(int pos = 0; pos < n; pos++) {
+        child[pos] = current;
+        // 从未访问集合和各邻居的邻居表中删去current
+        int last = unvisited[--remaining];
+        unvisited[positionInUnvisited[current]] = last;
+        positionInUnvisited[last] = positionInUnvisited[current];
+        for(int k = 0; k < degree[current]; k++) {
+            int v = neighbor[4 * current + k];
+            for(int m = 0; m < degree[v]; m++) {
+                if(neighbor[4 * v + m] == current) {
+                    neighbor[4 * v + m] = neighbor[4 * v + --degree[v]];
+                    break;
+                }
+            }
+        }
+        if(remaining == 0)
+            break;
+        // 选择下一个任务
+        int next = -1, ties = 0;
+        for(int k = 0; k < degree[current]; k++) {
+            int v = neighbor[4 * current + k];
+            if(next < 0 || degree[v] < degree[next]) {
+                next = v;
+                ties = 1;
+            }
+            else if(degree[v] == degree[next]) {
+                ties++;
+                if(std::uniform_int_distribution<int>(0, ties - 1)(rng) == 0) // 蓄水池抽样，相同者等概率
+                    next = v;
+            }
+        }
+        if(next < 0)
+            next = unvisited[std::uniform_int_distribution<int>(0, remaining - 1)(rng)];
+        current = next;
+    }
+}
+
+// 基于位置的交叉：每个位置以1/2的概率原位保留a的任务，其余位置按b的顺序填入b中未保留的任务
+template<class IndexT, class RngT>
+void crossoverPosition(const IndexT* a, const IndexT* b, int n, IndexT* child, RngT& rng) {
+    static thread_local MarkSet kept, keptPosition;
+    std::bernoulli_distribution rand_keep(0.5);
+    kept.reset(n);
+    keptPosition.reset(n);
+    for(int i=0; i<n; i++) {
+        if(rand_keep(rng)) {
+            child[i] = a[i];
+            kept.insert(a[i]);
+            keptPosition.insert(i);
+        }
+    }
+    int pos = 0;
+    for(int i=0; i<n; i++) {
+        if(kept.contains(b[i]))
+            continue;
+        while(keptPosition.contains(pos))
+            pos++;
+        child[pos++] = b[i];
+    }
+}
+
+// 按类型调用交叉算子
+template<class IndexT, class RngT>
+void crossover(CrossoverType type, const IndexT* a, const IndexT* b, int n, IndexT* child, RngT& rng) {
+    switch(type) {
+        case CROSSOVER_PMX: crossoverPMX(a, b, n, child, rng); break;
+        case CROSSOVER_CX: crossoverCX(a, b, n, child, rng); break;
+        case CROSSOVER_ERX: crossoverERX(a, b, n, child, rng); break;
+        case CROSSOVER_POSITION: crossoverPosition(a, b, n, child, rng); break;
+        default: crossoverOX(a, b, n, child, rng); break;
+    }
+}
+
+#endif
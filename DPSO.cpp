@@ -8,6 +8,19 @@
 #include <math.h>
 #include <time.h>
 #include <random>
+#include <atomic>
+#include <functional>
+#include "Makespan.h"
+#include "MakespanTree.h"
+#include "FitnessCache.h"
+#include "Population.h"
+#include "SwapSequence.h"
+#include "LowerBound.h"
+#include "StopCondition.h"
+#include "LocalSearch.h"
+#include "SweepRunner.h"
+#include "Scheduler.h"
+#include "AllocCounter.h"
 using namespace std;
 
 #define W 5000000.0 // 信道带宽（Hz）
@@ -21,8 +34,16 @@ using namespace std;
 #define POP_SIZE 30 // 粒子群规模
 #define EPOCH 1000 // 迭代次数
 #define POWER 5.0 // 发射功率（mW）
+#ifndef VELOCITY_CAP
+#define VELOCITY_CAP 0 // velocity最多包含的交换数，超出的交换不再应用；0表示不限，缓冲区初始为3n，满时加倍
+#endif
 
-default_random_engine rand_eng(time(0)); // 随机数
+// 单次运行的状态，各线程独立
+thread_local default_random_engine rand_eng(time(0)); // 随机数
+thread_local MakespanEvaluator evaluator; // 当前实例的makespan评估器
+thread_local PermutationHasher hasher; // 任务序列指纹
+thread_local FitnessCache fitnessCache; // 适应度缓存
+thread_local LocalSearch localSearch; // 精英个体的局部搜索
 
 // 由发射功率计算任务传输速率
 double R(double power) {
@@ -41,79 +62,95 @@ class Task {
         }
 };
 
-// 计算变换序列
-vector<pair<int, int>> calcSwapSequence(const vector<Task>& from, const vector<Task>& to) {
-    assert(from.size() == to.size());
-    vector<pair<int, int>> swapSequence;
-    auto emul = from; // 使用副本模拟变换，保证原序列不受影响
-    
-    for(int i=0; i<to.size(); i++) {
-        for(int j=i; j<emul.size(); j++) {
-            if(emul.at(j).id == to.at(i).id) { // 需取出Task的id进行比较
-                if(i != j) { // 在同一位置则不需要变化
-                    swapSequence.emplace_back(pair<int, int> (i, j));
-                    swap(emul.at(i), emul.at(j));
-                }
-                break;
-            }
-        }
-    }
-
-    return swapSequence;
-}
-
 class Particle {
     public:
         int id;
-        vector<Task> taskList;
+        TaskIndex* order; // 任务序列，指向arena中的一行
+        TaskIndex* origin; // 更新前的任务序列，指向arena中的一行
+        int n; // 任务数
         double fitness;
-        vector<pair<int, int>> velocity;
+        uint64_t fingerprint; // 任务序列指纹
+        uint64_t scored; // 当前fitness所对应的指纹，与fingerprint相同时任务序列未变，不必重新计算
+        default_random_engine rng; // 个体独立的随机数序列，并行更新时结果与线程数无关
+        SwapBuffer velocityBuffer[2]; // 双缓冲，velocityBuffer[current]为当前velocity，更新时写入另一个
+        int current;
+        SwapWorkspace workspace; // 计算交换序列用
+        MakespanTree tree; // 用于应用变换序列后增量更新适应度
 
         double calcFitness();
+        void applySwap(int a, int b, const PermutationHasher& hasher);
+        void refreshFitness(FitnessCache& cache);
         void initVelocity();
+        void assign(const Particle& other);
 
-        Particle(int id, vector<Task> taskList) {
+        const SwapBuffer& velocity() const {
+            return velocityBuffer[current];
+        }
+
+        // order须已填入任务序列，velocity最多包含velocityCap个交换，velocityCap为0时不限
+        Particle(int id, TaskIndex* order, TaskIndex* origin, int n, int velocityCap) {
             this->id = id;
-            this->taskList = taskList;
+            this->rng.seed(rand_eng());
+            this->order = order;
+            this->origin = origin;
+            this->n = n;
+            this->current = 0;
+            velocityBuffer[0].reserve(velocityCap > 0 ? velocityCap : 3 * n, velocityCap > 0);
+            velocityBuffer[1].reserve(velocityCap > 0 ? velocityCap : 3 * n, velocityCap > 0);
+            workspace.reserve(n);
             this->fitness = calcFitness(); // 自动计算适应度
             this->initVelocity(); // 自动生成初始velocity
         }
         Particle() {
             this->id = -1;
+            this->order = nullptr;
+            this->origin = nullptr;
+            this->n = 0;
+            this->current = 0;
             this->fitness = INT_MAX;
+            this->fingerprint = 0;
+            this->scored = 1; // 与fingerprint不同，即fitness尚未计算
         }
 };
-// 生成初始velocity
+// 生成初始velocity：变换到随机任务序列的交换序列
+// 正向Fisher-Yates洗牌的交换(i, j >= i)与calcSwapSequence()的输出一一对应，直接抽取即可，不复制任务序列
 void Particle::initVelocity() {
-    auto randomTaskList = this->taskList;
-    shuffle(randomTaskList.begin(), randomTaskList.end(), rand_eng);
-
-    this->velocity = calcSwapSequence(this->taskList, randomTaskList);
+    SwapBuffer& velocity = velocityBuffer[current];
+    velocity.clear();
+    for(int i=0; i + 1 < n; i++) {
+        uniform_int_distribution<int> rand_pos(i, n - 1);
+        int j = rand_pos(rand_eng);
+        if(j != i && ! velocity.push(i, j))
+            break;
+    }
+}
+// 把另一个粒子的任务序列和适应度复制到本粒子的行，用于保存第一名和历史最佳
+void Particle::assign(const Particle& other) {
+    copy(other.order, other.order + n, order);
+    fitness = other.fitness;
+    fingerprint = other.fingerprint;
+    scored = other.scored;
 }
 // 计算fitness（makespan）
 double Particle::calcFitness() {
-    vector<double> t_ready, t_complete;
-    double sum_dataSize = 0.0; // 前i个任务的数据量和
-    for(auto i = taskList.begin(); i != taskList.end(); i++) {
-        sum_dataSize += (*i).dataSize; // 前i个任务的数据量和
-        t_ready.emplace_back(sum_dataSize / R(POWER)); // 第i个任务的准备时间
-        double t_dispose_i = (*i).cyclePerBit * (*i).dataSize / F; // 第i个任务的执行时间
-        // 第i个任务的完成时间
-        if(i == taskList.begin()) {
-            assert(t_complete.empty()); // i=1
-            t_complete.emplace_back( *(t_ready.rbegin()) + t_dispose_i ); // t_ready_i + t_dispose_i
-        }
-        else {
-            assert( ! t_complete.empty()); // i>1
-            double t_ready_i = *(t_ready.rbegin()), t_complete_i_1 = *(t_complete.rbegin());
-            t_complete.emplace_back(
-                (t_ready_i > t_complete_i_1 ? t_ready_i : t_complete_i_1) + t_dispose_i
-            ); // max{t_ready_i, t_complete_(i-1)} + t_dispose_i
-        }
-    }
-
-    assert(t_complete.size() == taskList.size());
-    return *(max_element(t_complete.begin(), t_complete.end()));
+    tree.build(evaluator, order, n); // 同时重建线段树
+    fingerprint = hasher.hash(order, n);
+    scored = fingerprint;
+    return fitnessCache.fetch(fingerprint, [this]{ return tree.makespan(); });
+}
+// 应用一次交换，线段树暂不更新
+void Particle::applySwap(int a, int b, const PermutationHasher& hasher) {
+    fingerprint += hasher.swapDelta(a, b, order[a], order[b]);
+    swap(order[a], order[b]);
+    tree.markSwap(a, b);
+}
+// 更新fitness：任务序列未变（未应用交换或交换相互抵消）时跳过，线段树中待更新的交换留到下次
+// 否则先查缓存，未命中时由线段树更新，代价为O(min(k log n, n))，k为应用的交换数
+void Particle::refreshFitness(FitnessCache& cache) {
+    if(cache.unchanged(fingerprint, scored))
+        return;
+    scored = fingerprint;
+    fitness = cache.fetch(fingerprint, [this]{ tree.flush(); return tree.makespan(); });
 }
 
 // 读取Instance文件，格式：id - dataSize - cyclePerBit
@@ -134,92 +171,126 @@ vector<Task> readInstanceFile(string fileDir) {
     return taskList;
 }
 
-int main() {
+// 单次运行，返回记录行
+string runInstance(const SweepJob& job) {
+    rand_eng.seed(job.seed); // 每次运行使用独立的随机数序列
     string resultReport = "";
 
-// 实例测试
-vector<string> iTN {"10", "20", "30", "40", "50", "60", "70", "80", "90", "100"}; // 实例任务数量
-vector<string> iID {"0", "1", "2", "3", "4", "5", "6", "7", "8", "9"}; // 实例编号
-int iRepeatTimes = 5; // 每个实例重复次数
-
-for(auto it_n = iTN.begin(); it_n != iTN.end(); it_n++) { // 实例任务数量循环开始
-for(auto it_id = iID.begin(); it_id != iID.end(); it_id++) { // 实例编号循环开始
-for(int i_r = 0; i_r < iRepeatTimes; i_r++) { // 实例重复测试开始
-
     // 读取任务序列
-    vector<Task> taskList = readInstanceFile("./TestInstances/" + *it_n + "/" + *it_n + "_" + *it_id + ".txt");
+    vector<Task> taskList = readInstanceFile("./TestInstances/" + job.taskNum + "/" + job.taskNum + "_" + job.instanceId + ".txt");
+    evaluator.build(taskList, R(POWER), F); // 预计算传输时间和执行时间
+    hasher.build(taskList.size());
+    fitnessCache.clear();
+    localSearch.clear();
+    LowerBound lowerBound(evaluator); // 实例的下界，只计算一次，用于提前停止和计算差距
 
     // 记录历代最优值
     vector<double> championFitnessRecord;
+    championFitnessRecord.reserve(EPOCH);
     
     // 开始计时
     struct timeval startTime;
     mingw_gettimeofday(&startTime, NULL);
+    StopCondition stopCondition(TIME_BUDGET_MS, STAGNATION_EPOCHS, lowerBound.value); // 停止条件，达到下界即停止
 
-    // 初始化粒子群
+    // 初始化粒子群，任务序列存放在arena中，第POP_SIZE、POP_SIZE+1行存放第一名和历史最佳，其后POP_SIZE行存放更新前的任务序列
+    int n = taskList.size();
+    int velocityCap = VELOCITY_CAP;
+    PermutationArena arena;
+    arena.build(2 * POP_SIZE + 2, n);
     vector<Particle> swarm;
+    swarm.reserve(POP_SIZE);
     Particle bestParticle, championParticle;
+    bestParticle.order = arena.row(POP_SIZE);
+    championParticle.order = arena.row(POP_SIZE + 1);
+    bestParticle.n = championParticle.n = n;
     championParticle.fitness = INT_MAX;
     for(int i=0; i<POP_SIZE; i++) {
         shuffle(taskList.begin(), taskList.end(), rand_eng); // 随机个体
-        swarm.emplace_back( Particle(i, taskList) ); // 列入种群，自动计算适应度
+        TaskIndex* order = arena.row(i);
+        for(int j=0; j<n; j++)
+            order[j] = taskList[j].id;
+        swarm.emplace_back( Particle(i, order, arena.row(POP_SIZE + 2 + i), n, velocityCap) ); // 列入种群，自动计算适应度
     }
-    // 初始设置第一名和历史最佳
-    sort( swarm.begin(), swarm.end(), [](Particle a, Particle b){return a.fitness < b.fitness;} );
-    bestParticle = swarm.at(0);
+    // 初始设置第一名和历史最佳，按下标排名，粒子本身不移动
+    vector<int> rank;
+    rankByFitness(swarm, rank);
+    bestParticle.assign(swarm.at(rank.at(0)));
     if(bestParticle.fitness < championParticle.fitness)
-        championParticle = bestParticle;
+        championParticle.assign(bestParticle);
 
-    // 粒子群算法迭代
-    for(int epo = 0; epo < EPOCH; epo++) {
-        // 对于每一个粒子
-        for(auto i = swarm.begin(); i != swarm.end(); i++) {
+    // 子任务可能被其他线程窃取执行，通过引用使用本次运行的状态
+    const PermutationHasher& runHasher = hasher;
+    FitnessCache& runCache = fitnessCache;
+
+    // 初始化之后的堆分配次数：本线程上除调度器内部以外的分配，加上粒子更新在各线程上的分配
+    atomic<long long> updateAllocCount(0);
+    long long schedulerAllocCount = 0;
+
+    // 更新一段粒子，只读取上一代的bestParticle和championParticle；只构造一次，每代不再分配
+    const function<void(int, int)> updateSwarm = [&](int begin, int end) {
+        long long allocBefore = threadAllocCount();
+        for(auto i = swarm.begin() + begin; i != swarm.begin() + end; i++) {
             // 参数
             double c_1 = 0.5;
             double c_2 = 0.5;
             double c_3 = 0.5;
 
-            // 计算变换序列
-            auto bestSwapSequence = calcSwapSequence((*i).taskList, bestParticle.taskList);
-            auto championSwapSequence = calcSwapSequence((*i).taskList, championParticle.taskList);
+            // 变换序列均由更新前的位置计算
+            copy((*i).order, (*i).order + n, (*i).origin);
 
-            // 新的velocity
-            decltype((*i).velocity) newVelocity;
+            // 新的velocity写入另一个缓冲区，设置了VELOCITY_CAP且已满时其余交换不再应用
+            const SwapBuffer& velocity = (*i).velocityBuffer[(*i).current];
+            SwapBuffer& newVelocity = (*i).velocityBuffer[1 - (*i).current];
+            newVelocity.clear();
+            auto apply = [&](int a, int b) {
+                if(newVelocity.push(a, b))
+                    (*i).applySwap(a, b, runHasher);
+            };
 
             uniform_real_distribution<double> rand_real(0.0, 1.0);
-            for(auto i_ss = (*i).velocity.begin(); i_ss != (*i).velocity.end(); i_ss++) {
-                if(rand_real(rand_eng) < c_1) {
-                    newVelocity.emplace_back((*i_ss));
-                    swap((*i).taskList.at((*i_ss).first), (*i).taskList.at((*i_ss).second));
-                }
-            }
-            for(auto i_ss = bestSwapSequence.begin(); i_ss != bestSwapSequence.end(); i_ss++) {
-                if(rand_real(rand_eng) < c_2) {
-                    newVelocity.emplace_back((*i_ss));
-                    swap((*i).taskList.at((*i_ss).first), (*i).taskList.at((*i_ss).second));
-                }
-            }
-            for(auto i_ss = championSwapSequence.begin(); i_ss != championSwapSequence.end(); i_ss++) {
-                if(rand_real(rand_eng) < c_3) {
-                    newVelocity.emplace_back((*i_ss));
-                    swap((*i).taskList.at((*i_ss).first), (*i).taskList.at((*i_ss).second));
-                }
+            for(auto i_ss = velocity.begin(); i_ss != velocity.end(); i_ss++) {
+                if(rand_real((*i).rng) < c_1)
+                    apply((*i_ss).first, (*i_ss).second);
             }
+            // 以概率c_2、c_3应用变换到第一名和历史最佳的交换序列，不生成序列
+            applySwapSequence((*i).origin, bestParticle.order, n, c_2, (*i).rng, (*i).workspace, apply);
+            applySwapSequence((*i).origin, championParticle.order, n, c_3, (*i).rng, (*i).workspace, apply);
 
-            (*i).velocity = newVelocity;
+            (*i).current = 1 - (*i).current;
 
             // 更新fitness
-            (*i).fitness = (*i).calcFitness();
+            (*i).refreshFitness(runCache);
         }
+        updateAllocCount.fetch_add(threadAllocCount() - allocBefore, memory_order_relaxed);
+    };
+
+    localSearch.reserve(n);
+    long long allocBase = threadAllocCount();
+
+    // 粒子群算法迭代，初始解已达到下界时不迭代
+    int epochs = stopCondition.solvedAtStart(championParticle.fitness) ? 0 : EPOCH;
+    for(int epo = 0; epo < epochs; epo++) {
+        // 并行更新每一个粒子
+        long long allocBefore = threadAllocCount();
+        scheduler().parallelFor(swarm.size(), updateSwarm);
+        schedulerAllocCount += threadAllocCount() - allocBefore;
 
         // 更新第一名和历史最佳
-        sort( swarm.begin(), swarm.end(), [](Particle a, Particle b){return a.fitness < b.fitness;} );
-        bestParticle = swarm.at(0);
+        rankByFitness(swarm, rank);
+        polishElites(localSearch, evaluator, swarm, rank); // 精英个体局部搜索
+        bestParticle.assign(swarm.at(rank.at(0)));
         if(bestParticle.fitness < championParticle.fitness)
-            championParticle = bestParticle;
+            championParticle.assign(bestParticle);
         championFitnessRecord.emplace_back(championParticle.fitness);
+
+        // 检查停止条件
+        if(stopCondition.shouldStop(epo + 1, championFitnessRecord))
+            break;
     }
 
+    long long allocCount = threadAllocCount() - allocBase - schedulerAllocCount + updateAllocCount.load();
+
     // 停止计时
     struct timeval endTime;
     mingw_gettimeofday(&endTime, NULL);
@@ -227,23 +298,32 @@ for(int i_r = 0; i_r < iRepeatTimes; i_r++) { // 实例重复测试开始
     double duration = (endTime.tv_sec - startTime.tv_sec)*1000.0 + (endTime.tv_usec - startTime.tv_usec)/1000.0;
 
     // 记录信息
-    resultReport += *it_n + "\t"; // 任务数量
-    resultReport += *it_id + '\t'; // 测试实例编号
-    resultReport += to_string(i_r) + "\t"; // 重复测试次数
+    resultReport += job.taskNum + "\t"; // 任务数量
+    resultReport += job.instanceId + '\t'; // 测试实例编号
+    resultReport += to_string(job.repeat) + "\t"; // 重复测试次数
     resultReport += to_string(championParticle.fitness) + "\t"; // 最优makespan
     resultReport += to_string(duration) + "\t"; // 运行时间
+    resultReport += to_string(fitnessCache.hits.load()) + "\t"; // 适应度缓存命中次数
+    resultReport += to_string(fitnessCache.misses.load()) + "\t"; // 适应度缓存未命中次数
+    resultReport += to_string(fitnessCache.skipped.load()) + "\t"; // 任务序列未变而跳过的计算次数
+    resultReport += to_string(lowerBound.value) + "\t"; // makespan的下界
+    resultReport += to_string(championParticle.fitness / lowerBound.value - 1.0) + "\t"; // 与下界的相对差距
+    resultReport += string(stopCondition.reasonName()) + "\t"; // 停止原因
+    resultReport += to_string(stopCondition.stopEpoch) + "\t"; // 停止时的代数
+    resultReport += to_string(localSearch.moves) + "\t"; // 局部搜索接受的移动数
+    resultReport += to_string(allocCount) + "\t"; // 初始化之后的堆分配次数
     resultReport += "\n";
+    return resultReport;
+}
 
-    // 控制台输出日志
-    time_t time_t_now = time(nullptr);
-    char* timeStamp = ctime(&time_t_now);
-    timeStamp[strlen(timeStamp) - 1] = 0;
-    cout << "[" << timeStamp <<"] ";
-    cout << "Completed Instance " + *it_n + "_" + *it_id + "_" + to_string(i_r) + ".\n";
+int main() {
+// 实例测试
+vector<string> iTN {"10", "20", "30", "40", "50", "60", "70", "80", "90", "100"}; // 实例任务数量
+vector<string> iID {"0", "1", "2", "3", "4", "5", "6", "7", "8", "9"}; // 实例编号
+int iRepeatTimes = 5; // 每个实例重复次数
 
-} // 实例重复测试结束
-} // 实例编号循环结束
-} // 实例任务数量循环结束
+    // 并行运行全部实例，按原顺序汇总
+    string resultReport = runSweep(iTN, iID, iRepeatTimes, time(0), runInstance);
 
     // 写入输出文件
     ofstream fileOut;
@@ -0,0 +1,81 @@
+#ifndef DERANGEMENT_H
+#define DERANGEMENT_H
+
+#include <assert.h>
+#include <random>
+#include <utility>
+#include <vector>
+
+#ifndef DERANGEMENT_EXACT_MAX
+#define DERANGEMENT_EXACT_MAX 10 // 不超过该规模时按错排数精确计算标记概率，更大时取近似值1/u
+#endif
+static_assert(DERANGEMENT_EXACT_MAX <= 20, "错排数D(20)以上超出long long的范围");
+
+// 错排采样中规模为u时标记被交换元素的概率 (u - 1) * D(u - 2) / D(u)，D为错排数
+// D以long long按递推式D(u) = (u - 1) * (D(u - 1) + D(u - 2))预先计算，首次调用时建表
+inline double derangementProb(int u) {
+    struct Table {
+        double prob[DERANGEMENT_EXACT_MAX + 1];
+        Table() {
+            long long d[DERANGEMENT_EXACT_MAX + 1];
+            d[0] = 1;
+            if(DERANGEMENT_EXACT_MAX >= 1)
+                d[1] = 0;
+            for(int u = 2; u <= DERANGEMENT_EXACT_MAX; u++)
+                d[u] = (u - 1) * (d[u - 1] + d[u - 2]);
+            prob[0] = prob[1] = 0.0; // 不会用到
+            for(int u = 2; u <= DERANGEMENT_EXACT_MAX; u++)
+                prob[u] = (u - 1.0) * d[u - 2] / d[u]; // u = 2时为1 * D(0) / D(2) = 1，即必定标记
+        }
+    };
+    static const Table table;
+    assert(u >= 2);
+    if(u > DERANGEMENT_EXACT_MAX)
+        return 1.0 / u;
+    return table.prob[u];
+}
+
+// 从taskSeq的n个位置中随机选出distance个，按错排采样打乱这些位置上的任务，写入newTaskSeq的对应位置，其余位置不写
+// 选位置时在线程局部的恒等下标表上做部分洗牌，用后按相反顺序换回，因此每次调用为O(distance)，不分配内存
+template<class IndexT, class RngT>
+void perturbPositions(const IndexT* taskSeq, int n, int distance, IndexT* newTaskSeq, RngT& rng) {
+    static thread_local std::vector<int> indexes, drawn, pickedIndex, marked; // 跨调用复用
+    static thread_local std::vector<IndexT> que;
+    assert(distance >= 1 && distance <= n);
+    while(indexes.size() < n)
+        indexes.emplace_back(indexes.size());
+    drawn.resize(distance);
+    pickedIndex.resize(distance);
+    marked.assign(distance, 0);
+    que.resize(distance);
+
+    for(int i=0; i<distance; i++) {
+        int rIndex = n - i - 1; // 反向遍历下标
+        std::uniform_int_distribution<int> rand_int(0, rIndex);
+        int swapIndex = rand_int(rng); // 随机取一个用来交换
+        std::swap(indexes[rIndex], indexes[swapIndex]);
+        drawn[i] = swapIndex;
+        pickedIndex[i] = indexes[rIndex]; // 记录已选的下标
+        que[i] = taskSeq[indexes[rIndex]];
+    }
+    for(int i = distance - 1; i >= 0; i--) // 恢复为恒等排列
+        std::swap(indexes[n - i - 1], indexes[drawn[i]]);
+
+    // 打乱选出的任务，被标记的位置不再参与交换
+    std::uniform_real_distribution<double> rand_p(0.0, 1.0);
+    for(int i = 0; i < distance - 1; i++) {
+        int rIndex = distance - i - 1; // 反向遍历下标
+        std::uniform_int_distribution<int> rand_int(0, rIndex);
+        int swapIndex = rand_int(rng);
+        if(marked[rIndex] == 1)
+            continue;
+        std::swap(que[rIndex], que[swapIndex]);
+        if(rand_p(rng) < derangementProb(rIndex + 1))
+            marked[swapIndex] = 1;
+    }
+
+    for(int i=0; i<distance; i++)
+        newTaskSeq[pickedIndex[i]] = que[i];
+}
+
+#endif
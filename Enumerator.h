@@ -0,0 +1,145 @@
+#ifndef ENUMERATOR_H
+#define ENUMERATOR_H
+
+#include <assert.h>
+#include <math.h>
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <numeric>
+#include <vector>
+#include "Makespan.h"
+#include "Scheduler.h"
+
+#ifndef SPLIT_DEPTH
+#define SPLIT_DEPTH 2 // 按前SPLIT_DEPTH个位置切分子树，每个前缀作为一个子任务
+#endif
+#ifndef PRUNE_TOLERANCE
+#define PRUNE_TOLERANCE 1.0E-9 // 下界不小于 现有最优解 * (1 - PRUNE_TOLERANCE) 时剪枝，最优值以该相对误差保证
+#endif
+
+// 精确枚举全部任务序列，适用于n不超过14左右的实例
+// 按前缀树深度优先遍历，每个节点携带前缀处理完后的(t_ready, t_complete)，子节点O(1)得到，不计算完整的makespan
+// 剩余任务集合S的下界：max(t_complete + Σ执行时间(S), t_ready + Σ传输时间(S) + min执行时间(S))，不小于现有最优解时剪去子树
+// 前SPLIT_DEPTH层的前缀分给调度器的各线程，现有最优解跨线程共享
+class PrefixEnumerator {
+    public:
+        std::vector<int> bestOrder; // 最优任务序列
+        double bestMakespan;
+        std::atomic<long long> nodes; // 访问的节点数
+
+        PrefixEnumerator() {
+            this->bestMakespan = HUGE_VAL;
+            this->nodes.store(0);
+        }
+
+        // 求解evaluator对应实例，返回最优makespan；initial为初始的可行序列，用于确定初始上界
+        double solve(const MakespanEvaluator& evaluator, const std::vector<int>& initial) {
+            this->evaluator = &evaluator;
+            int n = evaluator.size();
+            bestOrder = initial;
+            bestMakespan = evaluator.makespan(initial.data(), n);
+            incumbent.store(bestMakespan);
+            nodes.store(0);
+            totalTrans = std::accumulate(evaluator.t_trans.begin(), evaluator.t_trans.end(), 0.0);
+
+            // 列出前depth个位置的全部前缀，按字典序
+            int depth = SPLIT_DEPTH < n ? SPLIT_DEPTH : n;
+            std::vector<int> prefixes, prefix;
+            listPrefixes(n, depth, prefix, prefixes);
+            int prefixNum = depth > 0 ? prefixes.size() / depth : 1;
+
+            scheduler().parallelFor(prefixNum, [&](int begin, int end) {
+                std::vector<int> order(n);
+                std::vector<char> used(n);
+                for(int p = begin; p < end; p++) {
+                    // 前缀之后接剩余的任务
+                    std::fill(used.begin(), used.end(), 0);
+                    double ready = 0.0, complete = 0.0;
+                    for(int k=0; k<depth; k++) {
+                        int id = prefixes[p * depth + k];
+                        order[k] = id;
+                        used[id] = 1;
+                        advance(id, ready, complete);
+                    }
+                    for(int id = 0, k = depth; id < n; id++)
+                        if(! used[id])
+                            order[k++] = id;
+                    long long visited = 0;
+                    search(order.data(), n, depth, ready, complete, visited);
+                    nodes.fetch_add(visited, std::memory_order_relaxed);
+                }
+            });
+            return bestMakespan;
+        }
+
+    private:
+        const MakespanEvaluator* evaluator;
+        std::atomic<double> incumbent; // 现有最优解，各线程共享，只减小
+        std::mutex bestMutex; // 保护bestOrder和bestMakespan
+        double totalTrans;
+
+        static void listPrefixes(int n, int depth, std::vector<int>& prefix, std::vector<int>& prefixes) {
+            if(prefix.size() == depth) {
+                prefixes.insert(prefixes.end(), prefix.begin(), prefix.end());
+                return;
+            }
+            for(int id = 0; id < n; id++) {
+                if(std::find(prefix.begin(), prefix.end(), id) != prefix.end())
+                    continue;
+                prefix.emplace_back(id);
+                listPrefixes(n, depth, prefix, prefixes);
+                prefix.pop_back();
+            }
+        }
+
+        void advance(int id, double& ready, double& complete) const {
+            ready += evaluator->t_trans[id];
+            complete = (ready > complete ? ready : complete) + evaluator->t_dispose[id];
+        }
+
+        // order[0, depth)为已确定的前缀，order[depth, n)为剩余任务
+        void search(int* order, int n, int depth, double ready, double complete, long long& visited) {
+            visited++;
+            if(depth == n) {
+                offer(order, n, complete);
+                return;
+            }
+            const double* trans = evaluator->t_trans.data();
+            const double* dispose = evaluator->t_dispose.data();
+            double minDispose = HUGE_VAL, restDispose = 0.0;
+            for(int k = depth; k < n; k++) {
+                restDispose += dispose[order[k]];
+                if(dispose[order[k]] < minDispose)
+                    minDispose = dispose[order[k]];
+            }
+            double restTrans = totalTrans - ready;
+            double a = complete + restDispose, b = ready + restTrans + minDispose;
+            double bound = a > b ? a : b;
+            if(bound >= incumbent.load(std::memory_order_relaxed) * (1.0 - PRUNE_TOLERANCE))
+                return;
+            for(int k = depth; k < n; k++) {
+                std::swap(order[depth], order[k]);
+                int id = order[depth];
+                double childReady = ready + trans[id];
+                double childComplete = (childReady > complete ? childReady : complete) + dispose[id];
+                search(order, n, depth + 1, childReady, childComplete, visited);
+                std::swap(order[depth], order[k]);
+            }
+        }
+
+        // 完整序列，优于现有最优解时记录
+        void offer(const int* order, int n, double makespan) {
+            double current = incumbent.load(std::memory_order_relaxed);
+            while(makespan < current && ! incumbent.compare_exchange_weak(current, makespan, std::memory_order_relaxed)) {}
+            if(makespan >= current)
+                return;
+            std::lock_guard<std::mutex> lock(bestMutex);
+            if(makespan < bestMakespan) {
+                bestMakespan = makespan;
+                bestOrder.assign(order, order + n);
+            }
+        }
+};
+
+#endif
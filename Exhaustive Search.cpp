@@ -0,0 +1,179 @@
+#include <iostream>
+#include <fstream>
+#include <assert.h>
+#include <vector>
+#include <string.h>
+#include <algorithm>
+#include <math.h>
+#include <time.h>
+#include <map>
+#include <sstream>
+#include "Makespan.h"
+#include "Johnson.h"
+#include "SweepRunner.h"
+#include "Enumerator.h"
+using namespace std;
+
+#define W 5000000.0 // 信道带宽（Hz）
+#define G0 -40 // 路径损耗常数（dB）
+#define THETA 4 // 路径损耗指数
+#define D0 1 // 参考距离（m）
+#define D 100 // 传输距离（m）
+#define N0 -174 // 噪声功率谱密度（dB * m / Hz）
+#define F 1.0E9 // 服务器CPU频率（Hz）
+
+#define POWER 5.0 // 发射功率（mW）
+#define MAX_TASKS 14 // 只枚举任务数不超过该值的实例
+
+// 单次运行的状态，各线程独立
+thread_local MakespanEvaluator evaluator; // 当前实例的makespan评估器
+
+// 由发射功率计算任务传输速率
+double R(double power) {
+    return W * log(1 + 1.0E-12 * power / 3.981071705534985E-18 / W) / 0.6931471805599453;
+}
+
+class Task {
+    public:
+        int id;
+        double dataSize, cyclePerBit;
+
+        Task(int id, double dataSize, double cyclePerBit) {
+            this->id = id;
+            this->dataSize = dataSize;
+            this->cyclePerBit = cyclePerBit;
+        }
+};
+
+// 读取Instance文件，格式：id - dataSize - cyclePerBit
+vector<Task> readInstanceFile(string fileDir) {
+    vector<Task> taskList;
+    ifstream fileIn;
+    fileIn.open(fileDir);
+    assert(fileIn); // 已打开
+
+    int lineNum; fileIn >> lineNum;
+    for(int i=0; i<lineNum; i++) {
+        int id_t; double data_t, cycle_t;
+        fileIn >> id_t >> data_t >> cycle_t;
+        taskList.emplace_back( Task(id_t, data_t, cycle_t) );
+    }
+
+    fileIn.close();
+    return taskList;
+}
+
+// 求解一个实例，返回经枚举证明的最优makespan，nodes为访问的节点数
+double solveInstance(const string& taskNum, const string& instanceId, long long& nodes) {
+    vector<Task> taskList = readInstanceFile("./TestInstances/" + taskNum + "/" + taskNum + "_" + instanceId + ".txt");
+    evaluator.build(taskList, R(POWER), F); // 预计算传输时间和执行时间
+    vector<int> initial(taskList.size()); // 按任务id的顺序作为初始上界，不依赖其他算法
+    for(int i=0; i<initial.size(); i++)
+        initial[i] = i;
+    PrefixEnumerator enumerator;
+    double makespan = enumerator.solve(evaluator, initial);
+    nodes = enumerator.nodes.load();
+    return makespan;
+}
+
+// 单次运行，返回记录行，最优makespan写入makespan
+string runInstance(const SweepJob& job, double& makespan) {
+    string resultReport = "";
+
+    // 开始计时
+    struct timeval startTime;
+    mingw_gettimeofday(&startTime, NULL);
+
+    // 枚举全部任务序列
+    long long nodes;
+    makespan = solveInstance(job.taskNum, job.instanceId, nodes);
+
+    // 停止计时
+    struct timeval endTime;
+    mingw_gettimeofday(&endTime, NULL);
+    // 计算运行时间
+    double duration = (endTime.tv_sec - startTime.tv_sec)*1000.0 + (endTime.tv_usec - startTime.tv_usec)/1000.0;
+
+    // 记录信息
+    resultReport += job.taskNum + "\t"; // 任务数量
+    resultReport += job.instanceId + '\t'; // 测试实例编号
+    resultReport += to_string(job.repeat) + "\t"; // 重复测试次数
+    resultReport += to_string(makespan) + "\t"; // 最优makespan
+    resultReport += to_string(duration) + "\t"; // 运行时间
+    resultReport += to_string(nodes) + "\t"; // 访问的节点数
+    resultReport += to_string(makespan / johnsonMakespan(evaluator) - 1.0) + "\t"; // 与Johnson规则的相对差距，应为0
+    resultReport += "\n";
+    return resultReport;
+}
+
+// 以枚举得到的最优值检验结果文件：前四列为 任务数量 - 实例编号 - 重复次数 - 最优makespan，只检验任务数不超过MAX_TASKS的行
+// 输出检验的行数、达到最优的行数、平均和最大相对差距，低于最优值的行说明结果有误
+void validateResultFile(const string& fileDir, map<pair<string, string>, double>& optimum) {
+    ifstream fileIn(fileDir);
+    if(! fileIn) {
+        cout << fileDir << ": cannot open\n";
+        return;
+    }
+    int checked = 0, optimal = 0, invalid = 0;
+    double gapSum = 0.0, gapMax = 0.0;
+    string line;
+    while(getline(fileIn, line)) {
+        istringstream fields(line);
+        string taskNum, instanceId, repeat;
+        double makespan;
+        if(! (fields >> taskNum >> instanceId >> repeat >> makespan) || stoi(taskNum) > MAX_TASKS)
+            continue;
+        auto key = make_pair(taskNum, instanceId);
+        if(! optimum.count(key)) {
+            long long nodes;
+            optimum[key] = solveInstance(taskNum, instanceId, nodes);
+        }
+        double gap = makespan / optimum[key] - 1.0;
+        checked++;
+        if(makespan < optimum[key] - 5.0E-7) // 结果文件保留6位小数
+            invalid++;
+        else if(makespan <= optimum[key] + 5.0E-7)
+            optimal++;
+        gapSum += gap;
+        if(gap > gapMax)
+            gapMax = gap;
+    }
+    cout << fileDir << ": " << checked << " rows, " << optimal << " optimal, mean gap " << (checked ? gapSum / checked : 0.0)
+         << ", max gap " << gapMax << ", " << invalid << " below optimum\n";
+}
+
+int main(int argc, char* argv[]) {
+// 实例测试
+vector<string> iTN {"10", "20", "30", "40", "50", "60", "70", "80", "90", "100"}; // 实例任务数量
+vector<string> iID {"0", "1", "2", "3", "4", "5", "6", "7", "8", "9"}; // 实例编号
+
+    // 只枚举任务数不超过MAX_TASKS的实例
+    vector<string> smallTN;
+    for(auto i = iTN.begin(); i != iTN.end(); i++)
+        if(stoi(*i) <= MAX_TASKS)
+            smallTN.emplace_back(*i);
+
+    // 逐个运行实例，每个实例的子树切分给全部线程；结果确定，不重复
+    string resultReport = "";
+    map<pair<string, string>, double> optimum; // 各实例的最优makespan，供检验结果文件
+    for(auto it_n = smallTN.begin(); it_n != smallTN.end(); it_n++) {
+        for(auto it_id = iID.begin(); it_id != iID.end(); it_id++) {
+            double makespan;
+            resultReport += runInstance(SweepJob {*it_n, *it_id, 0, 0}, makespan);
+            optimum[make_pair(*it_n, *it_id)] = makespan;
+            cout << "Completed Instance " + *it_n + "_" + *it_id + ".\n";
+        }
+    }
+
+    // 写入输出文件
+    ofstream fileOut;
+    fileOut.open("./Test Result - Exhaustive Search.txt");
+    fileOut << resultReport;
+    fileOut.close();
+
+    // 可选参数：需检验的结果文件
+    for(int k = 1; k < argc; k++)
+        validateResultFile(argv[k], optimum);
+
+    return 0;
+}
@@ -0,0 +1,237 @@
+#ifndef FITNESS_CACHE_H
+#define FITNESS_CACHE_H
+
+#include <assert.h>
+#include <string.h>
+#include <stdint.h>
+#include <atomic>
+#include <type_traits>
+#include <vector>
+#include "Makespan.h"
+
+#ifndef CACHE_BITS
+#define CACHE_BITS 16 // 缓存槽位数为2^CACHE_BITS
+#endif
+
+// 任务序列指纹
+// h = Σ key[id_i] * weight[i] (mod 2^64)，交换位置i、j上的任务a、b后 h += (key[b] - key[a]) * (weight[i] - weight[j])
+class PermutationHasher {
+    public:
+        // 为n个任务生成随机键，固定种子，不占用算法的随机数序列
+        void build(int n, uint64_t seed = 0x9E3779B97F4A7C15ULL) {
+            key.resize(n);
+            weight.resize(n);
+            uint64_t state = seed;
+            for(int i=0; i<n; i++) {
+                key[i] = splitMix64(state);
+                weight[i] = splitMix64(state) | 1;
+            }
+        }
+
+        template<class TaskT>
+        uint64_t hash(const std::vector<TaskT>& taskList) const {
+            assert(taskList.size() == key.size());
+            uint64_t h = 0;
+            for(int i=0; i<taskList.size(); i++)
+                h += key[taskList[i].id] * weight[i];
+            return h;
+        }
+
+        template<class IndexT>
+        uint64_t hash(const IndexT* order, int n) const {
+            uint64_t h = 0;
+            for(int i=0; i<n; i++)
+                h += key[order[i]] * weight[i];
+            return h;
+        }
+
+        // 交换前位置i上为任务idAtI、位置j上为任务idAtJ，返回指纹增量
+        uint64_t swapDelta(int i, int j, int idAtI, int idAtJ) const {
+            return (key[idAtJ] - key[idAtI]) * (weight[i] - weight[j]);
+        }
+
+    private:
+        std::vector<uint64_t> key; // 按任务id
+        std::vector<uint64_t> weight; // 按位置
+
+        static uint64_t splitMix64(uint64_t& state) {
+            uint64_t z = (state += 0x9E3779B97F4A7C15ULL);
+            z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+            z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+            return z ^ (z >> 31);
+        }
+};
+
+// 有界的指纹-适应度缓存，直接映射，新值覆盖旧值
+// 每个槽位存(指纹^数据, 数据)两个字，读写均无锁；并发写入造成的撕裂在校验时表现为未命中
+class FitnessCache {
+    public:
+        std::atomic<long long> hits, misses; // 命中、未命中次数
+        std::atomic<long long> skipped; // 任务序列未变、跳过计算的次数，不查缓存
+
+        FitnessCache() : slots(1 << CACHE_BITS) {
+            clear();
+        }
+
+        // 清空缓存和计数，每次运行前调用
+        void clear() {
+            for(auto i = slots.begin(); i != slots.end(); i++) {
+                (*i).check.store(0, std::memory_order_relaxed);
+                (*i).data.store(0, std::memory_order_relaxed);
+            }
+            hits = 0;
+            misses = 0;
+            skipped = 0;
+        }
+
+        // 惰性计算：个体记录当前fitness所对应的指纹scored，指纹与之相同时任务序列未变，fitness沿用，计入skipped
+        bool unchanged(uint64_t fingerprint, uint64_t scored) {
+            if(fingerprint != scored)
+                return false;
+            skipped.fetch_add(1, std::memory_order_relaxed);
+            return true;
+        }
+
+        bool lookup(uint64_t fingerprint, double& fitness) {
+            const Slot& slot = slotOf(fingerprint);
+            fingerprint |= 1; // 避免与空槽位(0, 0)相符
+            uint64_t data = slot.data.load(std::memory_order_relaxed);
+            if((slot.check.load(std::memory_order_relaxed) ^ data) != fingerprint) {
+                misses.fetch_add(1, std::memory_order_relaxed);
+                return false;
+            }
+            memcpy(&fitness, &data, sizeof(double));
+            hits.fetch_add(1, std::memory_order_relaxed);
+            return true;
+        }
+
+        void store(uint64_t fingerprint, double fitness) {
+            Slot& slot = slotOf(fingerprint);
+            fingerprint |= 1;
+            uint64_t data;
+            memcpy(&data, &fitness, sizeof(double));
+            slot.check.store(fingerprint ^ data, std::memory_order_relaxed);
+            slot.data.store(data, std::memory_order_relaxed);
+        }
+
+        // 先查缓存，未命中时调用evaluate()计算并存入
+        template<class EvalT>
+        double fetch(uint64_t fingerprint, EvalT evaluate) {
+            double fitness;
+            if(lookup(fingerprint, fitness))
+                return fitness;
+            fitness = evaluate();
+            store(fingerprint, fitness);
+            return fitness;
+        }
+
+        // 带截断的fetch：命中时返回true，fitness为准确值
+        // 未命中时由evaluate(fitness)计算，返回其结果；返回false表示超过截断值被拒绝，fitness只是下界，不存入缓存
+        template<class EvalT>
+        bool fetchWithin(uint64_t fingerprint, double& fitness, EvalT evaluate) {
+            if(lookup(fingerprint, fitness))
+                return true;
+            if(! evaluate(fitness))
+                return false;
+            store(fingerprint, fitness);
+            return true;
+        }
+
+    private:
+        struct Slot {
+            std::atomic<uint64_t> check, data;
+        };
+        std::vector<Slot> slots;
+
+        // 槽位取乘法散列的高CACHE_BITS位；权重均为奇数，指纹的最低位对同一实例的所有序列相同，不能用作下标
+        Slot& slotOf(uint64_t fingerprint) {
+            return slots[(fingerprint * 0x9E3779B97F4A7C15ULL) >> (64 - CACHE_BITS)];
+        }
+};
+
+// 批量计算population[index[0]], ..., population[index[count - 1]]的适应度，index为nullptr时即population[0, count)
+// 跳过任务序列未变的个体，其余先查缓存，只对未命中的个体做批量计算
+// 个体需有order（任务id序列）、fingerprint、scored和fitness成员，fingerprint须已更新
+// 缓冲区为线程局部并跨调用复用，可在线程池的各线程上对种群的不同部分并行调用；任务序列按个体的下标类型复制，不加宽为int
+template<class IndividualT>
+void evaluatePopulation(const MakespanEvaluator& evaluator, FitnessCache& cache, IndividualT* population, const int* index, int count) {
+    typedef typename std::decay<decltype(population->order[0])>::type IndexT; // 按个体的任务下标类型复制，不加宽
+    static thread_local std::vector<IndexT> orders;
+    static thread_local std::vector<int> missed;
+    static thread_local std::vector<double> result;
+    int n = evaluator.size();
+    missed.clear();
+    for(int k=0; k<count; k++) {
+        int p = index ? index[k] : k;
+        if(cache.unchanged(population[p].fingerprint, population[p].scored))
+            continue;
+        population[p].scored = population[p].fingerprint;
+        if(! cache.lookup(population[p].fingerprint, population[p].fitness))
+            missed.emplace_back(p);
+    }
+    orders.resize(missed.size() * n);
+    result.resize(missed.size());
+    for(int m=0; m<missed.size(); m++) {
+        const auto& order = population[missed[m]].order;
+        for(int i=0; i<n; i++)
+            orders[m * n + i] = order[i];
+    }
+    evaluator.makespanBatch(orders.data(), missed.size(), n, result.data());
+    for(int m=0; m<missed.size(); m++) {
+        population[missed[m]].fitness = result[m];
+        cache.store(population[missed[m]].fingerprint, result[m]);
+    }
+}
+
+// 带截断的批量计算，用于只保留不差于cutoff的个体的选择：超过cutoff的个体提前停止计算，rejected置为true，fitness只是下界
+// 个体另需有rejected成员；未命中的个体由makespanBatchWithin()计算，启用SIMD时按通道组截断
+template<class IndividualT>
+void evaluatePopulationWithin(const MakespanEvaluator& evaluator, FitnessCache& cache, IndividualT* population, const int* index, int count, double cutoff) {
+    typedef typename std::decay<decltype(population->order[0])>::type IndexT; // 按个体的任务下标类型复制，不加宽
+    static thread_local std::vector<IndexT> orders;
+    static thread_local std::vector<int> missed;
+    static thread_local std::vector<double> result;
+    static thread_local std::vector<char> exact;
+    int n = evaluator.size();
+    missed.clear();
+    for(int k=0; k<count; k++) {
+        int p = index ? index[k] : k;
+        population[p].rejected = false;
+        if(cache.unchanged(population[p].fingerprint, population[p].scored))
+            continue;
+        population[p].scored = population[p].fingerprint;
+        if(! cache.lookup(population[p].fingerprint, population[p].fitness))
+            missed.emplace_back(p);
+    }
+    orders.resize(missed.size() * n);
+    result.resize(missed.size());
+    exact.resize(missed.size());
+    for(int m=0; m<missed.size(); m++) {
+        const auto& order = population[missed[m]].order;
+        for(int i=0; i<n; i++)
+            orders[m * n + i] = order[i];
+    }
+    evaluator.makespanBatchWithin(orders.data(), missed.size(), n, cutoff, result.data(), exact.data());
+    for(int m=0; m<missed.size(); m++) {
+        IndividualT& c = population[missed[m]];
+        c.fitness = result[m];
+        if(exact[m])
+            cache.store(c.fingerprint, result[m]);
+        else { // 被拒绝时fitness只是下界，不对应当前序列，也不存入缓存
+            c.rejected = true;
+            c.scored = ~c.fingerprint;
+        }
+    }
+}
+
+template<class IndividualT>
+void evaluatePopulation(const MakespanEvaluator& evaluator, FitnessCache& cache, IndividualT* population, int count) {
+    evaluatePopulation(evaluator, cache, population, (const int*)nullptr, count);
+}
+
+template<class IndividualT>
+void evaluatePopulation(const MakespanEvaluator& evaluator, FitnessCache& cache, std::vector<IndividualT>& population) {
+    evaluatePopulation(evaluator, cache, population.data(), population.size());
+}
+
+#endif
@@ -8,6 +8,17 @@
 #include <math.h>
 #include <time.h>
 #include <random>
+#include "Makespan.h"
+#include "MakespanTree.h"
+#include "FitnessCache.h"
+#include "Population.h"
+#include "LowerBound.h"
+#include "StopCondition.h"
+#include "LocalSearch.h"
+#include "SweepRunner.h"
+#include "Scheduler.h"
+#include "Channel.h"
+#include "Crossover.h"
 using namespace std;
 
 #define W 5000000.0 // 信道带宽（Hz）
@@ -22,7 +33,22 @@ using namespace std;
 #define EPOCH 1000 // 迭代次数
 #define POWER 5.0 // 发射功率（mW）
 
-default_random_engine rand_eng(time(0)); // 随机数
+#define ISLAND_NUM 1 // 岛屿（子种群）数，大于1时启用岛屿模型，每个岛屿一个线程，其中ISLAND_NUM - 1个为调度器之外的专用线程
+#define MIGRATION_INTERVAL 25 // 迁移间隔（代）
+#define MIGRANT_NUM 2 // 每次向每个邻居迁出的精英个体数
+#define MIGRATION_TOPOLOGY 0 // 迁移拓扑，0：单向环，1：全连接
+
+#define STEADY_STATE 0 // 1：稳态GA，每个子代由锦标赛选出父代，优于最差个体时原地替换，不再每代排序
+#define TOURNAMENT_SIZE 3 // 锦标赛规模
+#define ELITE_NUM (MIGRANT_NUM > 1 ? MIGRANT_NUM : 1) // 稳态GA跟踪的精英个数，用于取历史最佳和迁出
+
+// 单次运行的状态，各线程独立
+thread_local default_random_engine rand_eng(time(0)); // 随机数
+thread_local MakespanEvaluator evaluator; // 当前实例的makespan评估器
+thread_local PermutationHasher hasher; // 任务序列指纹
+thread_local FitnessCache fitnessCache; // 适应度缓存
+thread_local LocalSearch localSearch; // 精英个体的局部搜索
+CrossoverType crossoverType = (CrossoverType)CROSSOVER_TYPE; // 交叉算子，由命令行参数指定，运行期间只读
 
 // 由发射功率计算任务传输速率
 double R(double power) {
@@ -47,93 +73,226 @@ class Task {
 
 class Chromosome {
     public:
-        vector<Task> taskList;
+        TaskIndex* order; // 任务序列，指向arena中的一行
+        int n; // 任务数
         double fitness;
+        bool rejected; // 带截断的计算提前停止，fitness只是下界
+        uint64_t fingerprint; // 任务序列指纹
+        uint64_t scored; // 当前fitness所对应的指纹，与fingerprint相同时任务序列未变，不必重新计算
+        MakespanTree tree; // 用于变异后增量更新适应度，首次变异时建立
 
         double calcFitness();
 
-        Chromosome(vector<Task> taskList) {
-            this->taskList = taskList;
-            this->fitness = calcFitness(); // 自动计算适应度
-        }
         Chromosome() {
+            this->order = nullptr;
+            this->n = 0;
             this->fitness = INT_MAX;
+            this->rejected = false;
+            this->fingerprint = 0;
+            this->scored = 1; // 与fingerprint不同，即fitness尚未计算
         }
 };
 // 计算fitness（makespan）
 double Chromosome::calcFitness() {
-    vector<double> t_ready, t_complete;
-    double sum_dataSize = 0.0; // 前i个任务的数据量和
-    for(auto i = taskList.begin(); i != taskList.end(); i++) {
-        sum_dataSize += (*i).dataSize; // 前i个任务的数据量和
-        t_ready.emplace_back(sum_dataSize / R(POWER)); // 第i个任务的准备时间
-        double t_dispose_i = (*i).cyclePerBit * (*i).dataSize / F; // 第i个任务的执行时间
-        // 第i个任务的完成时间
-        if(i == taskList.begin()) {
-            assert(t_complete.empty()); // i=1
-            t_complete.emplace_back( *(t_ready.rbegin()) + t_dispose_i ); // t_ready_i + t_dispose_i
-        }
-        else {
-            assert( ! t_complete.empty()); // i>1
-            double t_ready_i = *(t_ready.rbegin()), t_complete_i_1 = *(t_complete.rbegin());
-            t_complete.emplace_back(
-                (t_ready_i > t_complete_i_1 ? t_ready_i : t_complete_i_1) + t_dispose_i
-            ); // max{t_ready_i, t_complete_(i-1)} + t_dispose_i
+    fingerprint = hasher.hash(order, n);
+    scored = fingerprint;
+    return fitnessCache.fetch(fingerprint, [this]{ return evaluator.makespan(order, n); }); // 先查缓存
+}
+
+// 迁移中的个体，按值传递任务序列
+struct Migrant {
+    vector<TaskIndex> order;
+    double fitness;
+    uint64_t fingerprint;
+};
+
+// GA的种群，slots[r]为arena第r行上的个体
+// members按种群顺序列出在用的行，选择、交叉、排序和迁移只移动行号，不复制个体
+// 世代模式下members按fitness升序排列；稳态模式下members组织为大顶堆，堆顶为最差个体，elite为最好的ELITE_NUM个个体组成的大顶堆
+class Population {
+    public:
+        PermutationArena arena;
+        vector<Chromosome> slots;
+        vector<int> members;
+        vector<int> elite;
+        vector<unsigned> childSeeds; // 交叉和变异用的缓冲区，跨代复用
+        vector<int> childRows;
+        vector<int> mutatedRows;
+        vector<double> scoredFitness;
+
+        void build(int rows, int n) {
+            arena.build(rows, n);
+            slots.assign(rows, Chromosome());
+            freeRows.clear();
+            for(int r = rows - 1; r >= 0; r--) {
+                slots[r].order = arena.row(r);
+                slots[r].n = n;
+                freeRows.emplace_back(r);
+            }
+            members.clear();
+            members.reserve(rows);
         }
-    }
 
-    assert(t_complete.size() == taskList.size());
-    return *(max_element(t_complete.begin(), t_complete.end()));
-}
+        // 取一个空闲行，原有的线段树和拒绝标记失效
+        int acquire() {
+            assert(! freeRows.empty());
+            int r = freeRows.back();
+            freeRows.pop_back();
+            slots[r].tree.clear();
+            slots[r].rejected = false;
+            return r;
+        }
+        void release(int r) {
+            freeRows.emplace_back(r);
+        }
 
-// Davis Crossover
-Chromosome crossover(const Chromosome& a, const Chromosome& b) {
-    vector<Task> newTaskList;
+        // 种群中的第k个个体
+        Chromosome& at(int k) {
+            return slots[members.at(k)];
+        }
 
-    uniform_int_distribution<int> rand_start(0, a.taskList.size() - 1); // 随机选择起始下标
-    int a_start = rand_start(rand_eng);
-    uniform_int_distribution<int> rand_end(a_start, a.taskList.size() - 1); // 随机选择结束下标
-    int a_end = rand_end(rand_eng);
+        // 按fitness升序排序
+        void sort() {
+            std::sort( members.begin(), members.end(), [this](int a, int b){return slots[a].fitness < slots[b].fitness;} );
+        }
 
-    vector<Task> gene;
-    gene.assign(a.taskList.begin() + a_start, a.taskList.begin() + a_end + 1); // 取选定的一段
+        // 最差个体的fitness，世代模式下须已排序
+        double worstFitness() const {
+            return slots[STEADY_STATE ? members.front() : members.back()].fitness;
+        }
 
-    auto it_b = b.taskList.begin();
-    int count_b = 0;
+        // 第m好的个体
+        const Chromosome& best(int m) {
+            return slots[bestRow(m)];
+        }
+        int bestRow(int m) {
+            if(! STEADY_STATE)
+                return members.at(m);
+            sortedElite.assign(elite.begin(), elite.end());
+            std::sort(sortedElite.begin(), sortedElite.end(), [this](int a, int b){ return better(a, b); });
+            return sortedElite.at(m);
+        }
 
-    while(count_b < a_start) { // 选定段之前的
-        assert(it_b != b.taskList.end()); // 确认b中仍有待选元素
-        if(find(gene.begin(), gene.end(), *it_b) == gene.end()) { // 选定段中没有该元素，即不重复
-            newTaskList.emplace_back(*it_b);
-            count_b++;
+        // 稳态模式：按（fitness，行号）建堆并选出精英，O(P)；行号参与比较，使最差个体与精英互不相同
+        void heapify() {
+            auto cmp = [this](int a, int b){ return better(a, b); };
+            make_heap(members.begin(), members.end(), cmp);
+            int eliteNum = members.size() < ELITE_NUM ? members.size() : ELITE_NUM;
+            elite.assign(members.begin(), members.end());
+            partial_sort(elite.begin(), elite.begin() + eliteNum, elite.end(), cmp);
+            elite.resize(eliteNum);
+            make_heap(elite.begin(), elite.end(), cmp);
+        }
+        // 淘汰最差个体，O(log P)
+        void removeWorst() {
+            assert(members.size() > elite.size()); // 最差个体不在精英中
+            pop_heap(members.begin(), members.end(), [this](int a, int b){ return better(a, b); });
+            release(members.back());
+            members.pop_back();
+        }
+        // 行r上的新个体优于最差个体时替换之并返回true，否则释放行r，O(log P)
+        bool replaceWorst(int r) {
+            auto cmp = [this](int a, int b){ return better(a, b); };
+            assert(members.size() > elite.size());
+            if(! better(r, members.front())) {
+                release(r);
+                return false;
+            }
+            pop_heap(members.begin(), members.end(), cmp);
+            release(members.back());
+            members.back() = r;
+            push_heap(members.begin(), members.end(), cmp);
+            if(better(r, elite.front())) { // 进入精英，挤出其中最差的，被挤出者仍在种群中
+                pop_heap(elite.begin(), elite.end(), cmp);
+                elite.back() = r;
+                push_heap(elite.begin(), elite.end(), cmp);
+            }
+            return true;
+        }
+        // 锦标赛选择，返回随机抽取的TOURNAMENT_SIZE个个体中最好者的行
+        int tournament(default_random_engine& rng) {
+            uniform_int_distribution<int> rand_member(0, members.size() - 1);
+            int winner = members[rand_member(rng)];
+            for(int k = 1; k < TOURNAMENT_SIZE; k++) {
+                int r = members[rand_member(rng)];
+                if(better(r, winner))
+                    winner = r;
+            }
+            return winner;
         }
-        it_b++;
-    }
 
-    newTaskList.insert(newTaskList.end(), gene.begin(), gene.end()); //插入选定段
+    private:
+        vector<int> freeRows;
+        vector<int> sortedElite;
 
-    while(it_b != b.taskList.end()) { // 选定段之后的
-        if(find(gene.begin(), gene.end(), *it_b) == gene.end()) { // 选定段中没有该元素，即不重复
-            newTaskList.emplace_back(*it_b);
+        // 按（fitness，行号）比较，a优于b时返回true
+        bool better(int a, int b) const {
+            if(slots[a].fitness != slots[b].fitness)
+                return slots[a].fitness < slots[b].fitness;
+            return a < b;
         }
-        it_b++;
-    }
+};
 
-    assert(newTaskList.size() == a.taskList.size());
-    return Chromosome(newTaskList); // 自动计算了新的适应度
+// 交叉，算子由crossoverType选择，默认为Davis Crossover
+// 可作为子任务并行执行，只使用传入的随机数，子代写入child的行，其fingerprint和fitness由调用者计算
+void crossover(const Chromosome& a, const Chromosome& b, Chromosome& child, default_random_engine& rng) {
+    crossover(crossoverType, a.order, b.order, a.n, child.order, rng);
 }
 
-// 变异
+// 变异，只更新任务序列、指纹和已建立的线段树，fitness由refreshFitness()计算
 void mutate(Chromosome& c) {
     uniform_int_distribution<int> rand_mut_num(1, 3);
     int mutationNum = rand_mut_num(rand_eng);
     for(int i=0; i<mutationNum; i++) {
-        uniform_int_distribution<int> rand_mut_index(0, c.taskList.size() - 1);
+        uniform_int_distribution<int> rand_mut_index(0, c.n - 1);
         int mutationIndex_1 = rand_mut_index(rand_eng);
         int mutationIndex_2 = rand_mut_index(rand_eng);
-        swap(c.taskList.at(mutationIndex_1), c.taskList.at(mutationIndex_2));
+        c.fingerprint += hasher.swapDelta(mutationIndex_1, mutationIndex_2, c.order[mutationIndex_1], c.order[mutationIndex_2]);
+        swap(c.order[mutationIndex_1], c.order[mutationIndex_2]);
+        if(! c.tree.empty())
+            c.tree.markSwap(mutationIndex_1, mutationIndex_2);
     }
-    c.fitness = c.calcFitness(); // 重新计算适应度
+}
+
+// 计算变异后的准确fitness：任务序列未变（交换相互抵消）时跳过
+// 否则先查缓存，未命中时由线段树增量更新，线段树尚未建立时建立
+void refreshFitness(Chromosome& c) {
+    c.rejected = false;
+    if(fitnessCache.unchanged(c.fingerprint, c.scored))
+        return;
+    c.scored = c.fingerprint;
+    c.fitness = fitnessCache.fetch(c.fingerprint, [&c]{
+        if(c.tree.empty())
+            c.tree.build(evaluator, c.order, c.n);
+        else
+            c.tree.flush();
+        return c.tree.makespan();
+    });
+}
+
+// 对最好的LOCAL_SEARCH_ELITES个个体做局部搜索，有改进时恢复种群的顺序（世代模式）或堆（稳态模式）
+// 稳态模式下只在跟踪的精英中选取
+void polishElites(Population& population) {
+    if(! LOCAL_SEARCH)
+        return;
+    int eliteNum = STEADY_STATE ? population.elite.size() : population.members.size();
+    bool improved = false;
+    for(int m = 0; m < LOCAL_SEARCH_ELITES && m < eliteNum; m++) {
+        Chromosome& c = population.slots[population.bestRow(m)];
+        long long moves = localSearch.moves;
+        localSearch.improve(evaluator, c.order, c.n);
+        if(localSearch.moves != moves) {
+            c.fitness = c.calcFitness();
+            c.tree.clear(); // 下次变异时重建
+            improved = true;
+        }
+    }
+    if(! improved)
+        return;
+    if(STEADY_STATE)
+        population.heapify();
+    else
+        population.sort();
 }
 
 // 读取Instance文件，格式：id - dataSize - cyclePerBit
@@ -154,20 +313,301 @@ vector<Task> readInstanceFile(string fileDir) {
     return taskList;
 }
 
-int main() {
-    string resultReport = "";
+// 初始化种群，世代模式下按fitness升序排序，稳态模式下建堆
+// 所需行数：选择后余POP_SIZE个，交叉再产生POP_SIZE - 1个；每次迁入的个体不超过各入边队列的容量（小于4 * MIGRANT_NUM）之和
+void initPopulation(Population& population, vector<Task> taskList) {
+    int n = taskList.size();
+    population.build(2 * POP_SIZE + (ISLAND_NUM - 1) * 4 * MIGRANT_NUM, n);
+    for(int i=0; i<POP_SIZE; i++) {
+        shuffle(taskList.begin(), taskList.end(), rand_eng); // 随机个体
+        int r = population.acquire();
+        Chromosome& c = population.slots[r];
+        for(int j=0; j<n; j++)
+            c.order[j] = taskList[j].id;
+        c.fitness = c.calcFitness();
+        population.members.emplace_back(r); // 列入种群
+    }
+    if(STEADY_STATE)
+        population.heapify();
+    else
+        population.sort();
+}
 
-// 实例测试
-vector<string> iTN {"10", "20", "30", "40", "50", "60", "70", "80", "90", "100"}; // 实例任务数量
-vector<string> iID {"0", "1", "2", "3", "4", "5", "6", "7", "8", "9"}; // 实例编号
-int iRepeatTimes = 5; // 每个实例重复次数
+// 按fitness升序排序，前POP_SIZE名中被拒绝的个体（fitness只是下界）补全fitness后重新排序，直到前POP_SIZE名都是准确值
+// 截断值取自变异后的准确fitness，被拒绝的个体本不会进入前POP_SIZE名，此处只作保证；其余被拒绝的个体在下一代选择时淘汰
+void resolveRejected(Population& population) {
+    for(bool resolved = true; resolved; ) {
+        population.sort();
+        resolved = false;
+        for(int k=0; k<POP_SIZE && k<population.members.size(); k++) {
+            Chromosome& c = population.at(k);
+            if(c.rejected) {
+                c.fitness = c.calcFitness();
+                c.rejected = false;
+                resolved = true;
+            }
+        }
+    }
+}
+
+// 遗传算法的一代，结束时种群按fitness升序排序
+void evolve(Population& population) {
+    // 选择
+    while(population.members.size() > POP_SIZE) {
+        population.release(population.members.back());
+        population.members.pop_back(); // 已经按fitness升序排序，末位淘汰
+    }
 
-for(auto it_n = iTN.begin(); it_n != iTN.end(); it_n++) { // 实例任务数量循环开始
-for(auto it_id = iID.begin(); it_id != iID.end(); it_id++) { // 实例编号循环开始
-for(int i_r = 0; i_r < iRepeatTimes; i_r++) { // 实例重复测试开始
+    // 交叉，依次让第i、i+1个个体交叉，子代追加到种群末尾，也会参与后面的交叉
+    // 第k个子代的父代是第2k、2k+1个个体，按依赖分批，父代都已产生的子代为一批，批内并行
+    // 交叉只用到任务序列，子代只计算指纹，fitness推迟到变异之后
+    int parentNum = population.members.size();
+    int childNum = parentNum > 1 ? parentNum - 1 : 0;
+    vector<unsigned>& childSeeds = population.childSeeds; // 每个子代独立的随机数序列，结果与线程数无关
+    childSeeds.clear();
+    for(int k = 0; k < childNum; k++)
+        childSeeds.emplace_back(rand_eng());
+    const MakespanEvaluator& runEvaluator = evaluator; // 子任务可能被其他线程窃取执行，通过引用使用本次运行的状态
+    const PermutationHasher& runHasher = hasher;
+    FitnessCache& runCache = fitnessCache;
+    vector<int>& childRows = population.childRows; // 本批子代所在的行
+    for(int batchBegin = 0; batchBegin < childNum; ) {
+        int batchEnd = population.members.size() / 2 < childNum ? population.members.size() / 2 : childNum;
+        childRows.clear();
+        for(int k = batchBegin; k < batchEnd; k++)
+            childRows.emplace_back(population.acquire());
+        scheduler().parallelFor(childRows.size(), [&](int begin, int end) {
+            for(int c = begin; c < end; c++) {
+                int k = batchBegin + c;
+                Chromosome& child = population.slots[childRows[c]];
+                default_random_engine rng(childSeeds[k]);
+                crossover(population.at(2 * k), population.at(2 * k + 1), child, rng);
+                child.fingerprint = runHasher.hash(child.order, child.n);
+            }
+        });
+        population.members.insert(population.members.end(), childRows.begin(), childRows.end());
+        batchBegin = batchEnd;
+    }
+
+    // 变异，变异过的个体由线段树计算准确的fitness，未变异的子代留待截断计算
+    vector<int>& mutatedRows = population.mutatedRows;
+    mutatedRows.clear();
+    childRows.clear();
+    for(int k = 0; k < population.members.size(); k++) {
+        int r = population.members[k];
+        uniform_real_distribution<double> rand_real(0.0, 1.0);
+        double mutateOrNot = rand_real(rand_eng);
+        if(mutateOrNot < 0.15) {
+            mutate(population.slots[r]);
+            mutatedRows.emplace_back(r);
+        }
+        else if(k >= parentNum)
+            childRows.emplace_back(r);
+    }
+    for(auto i = mutatedRows.begin(); i != mutatedRows.end(); i++)
+        refreshFitness(population.slots[*i]);
+
+    // 父代和变异过的子代的fitness都已准确，其中第POP_SIZE小者为截断值，差于它的子代不可能留到下一代，不必算完
+    vector<double>& scoredFitness = population.scoredFitness;
+    scoredFitness.clear();
+    for(int k = 0; k < population.members.size(); k++) {
+        const Chromosome& c = population.at(k);
+        if(k < parentNum || c.scored == c.fingerprint)
+            scoredFitness.emplace_back(c.fitness);
+    }
+    double cutoff = HUGE_VAL;
+    if(scoredFitness.size() >= POP_SIZE) {
+        nth_element(scoredFitness.begin(), scoredFitness.begin() + (POP_SIZE - 1), scoredFitness.end());
+        cutoff = scoredFitness[POP_SIZE - 1];
+    }
+    scheduler().parallelFor(childRows.size(), [&](int begin, int end) {
+        evaluatePopulationWithin(runEvaluator, runCache, population.slots.data(), childRows.data() + begin, end - begin, cutoff);
+    });
+
+    resolveRejected(population);
+    polishElites(population);
+}
+
+// 稳态GA的一代：依次产生与世代模式相同数目的子代，每个子代立即参与后续的选择
+// 父代由锦标赛选出，子代与父代不同且优于最差个体时原地替换之；每个子代O(TOURNAMENT_SIZE + n + log P)，不排序种群
+// 子代之间有依赖，顺序执行
+void evolveSteadyState(Population& population) {
+    int childNum = population.members.size() > 1 ? population.members.size() - 1 : 0;
+    for(int k = 0; k < childNum; k++) {
+        const Chromosome& a = population.slots[population.tournament(rand_eng)];
+        const Chromosome& b = population.slots[population.tournament(rand_eng)];
+        int r = population.acquire();
+        Chromosome& child = population.slots[r];
+        crossover(a, b, child, rand_eng);
+        child.fingerprint = hasher.hash(child.order, child.n);
+
+        // 变异
+        uniform_real_distribution<double> rand_real(0.0, 1.0);
+        double mutateOrNot = rand_real(rand_eng);
+        if(mutateOrNot < 0.15) {
+            mutate(child);
+            refreshFitness(child); // 由线段树计算变异后的fitness
+        }
+        else if(fitnessCache.unchanged(child.fingerprint, child.scored)) // 行中原有个体与子代相同，fitness沿用
+            child.rejected = false;
+        else { // 以最差个体的fitness为截断值，超过时不可能替换之
+            double cutoff = population.worstFitness();
+            child.rejected = ! fitnessCache.fetchWithin(child.fingerprint, child.fitness, [&child, cutoff](double& fitness) {
+                return evaluator.makespanWithin(child.order, child.n, cutoff, fitness);
+            });
+            child.scored = child.rejected ? ~child.fingerprint : child.fingerprint;
+        }
+
+        if(child.rejected || child.fingerprint == a.fingerprint || child.fingerprint == b.fingerprint) // 差于最差个体或与父代相同，不加入种群
+            population.release(r);
+        else
+            population.replaceWorst(r);
+    }
+    polishElites(population);
+}
+
+// 岛屿from是否向岛屿to迁出
+bool isMigrationEdge(int from, int to) {
+    if(from == to)
+        return false;
+    if(MIGRATION_TOPOLOGY == 1)
+        return true; // 全连接
+    return to == (from + 1) % ISLAND_NUM; // 单向环
+}
+
+// 岛屿的运行结果
+struct IslandResult {
+    double championFitness;
+    StopReason reason;
+    int stopEpoch;
+    long long cacheHits, cacheMisses, skippedEvaluations;
+    long long localSearchMoves;
+};
+
+// 岛屿模型：每个岛屿在独立线程上进化，每隔MIGRATION_INTERVAL代经无锁队列向邻居迁出精英个体，迁入个体参与下一代的末位淘汰
+// 任一岛屿达到下界后其余岛屿随即停止
+// 岛屿的进化使用线程局部状态，不能作为调度器的子任务执行：岛屿0在调用的工作线程上运行，其余ISLAND_NUM - 1个岛屿各占一个专用线程
+// 专用线程不属于调度器，全部作业同时运行岛屿模型时线程数可达调度器线程数的ISLAND_NUM倍，应相应减小THREAD_NUM
+// 专用线程上的parallelFor子任务进入调度器的公共队列，可由空闲的工作线程窃取
+vector<IslandResult> runIslands(const vector<Task>& taskList, double lowerBound) {
+    // channels[from * ISLAND_NUM + to]为from到to的迁移队列
+    vector<unique_ptr<SpscChannel<Migrant>>> channels(ISLAND_NUM * ISLAND_NUM);
+    for(int from = 0; from < ISLAND_NUM; from++)
+        for(int to = 0; to < ISLAND_NUM; to++)
+            if(isMigrationEdge(from, to))
+                channels.at(from * ISLAND_NUM + to).reset(new SpscChannel<Migrant>(2 * MIGRANT_NUM));
+
+    vector<unsigned> seeds; // 由本次运行的随机数序列导出各岛屿的种子
+    for(int k=0; k<ISLAND_NUM; k++)
+        seeds.emplace_back(rand_eng());
+    const MakespanEvaluator& sharedEvaluator = evaluator;
+    const PermutationHasher& sharedHasher = hasher;
+    atomic<bool> solved(false);
+    vector<IslandResult> results(ISLAND_NUM);
+
+    auto runIsland = [&](int k) {
+        // 岛屿线程的运行状态，岛屿0沿用调用线程的评估器和指纹
+        rand_eng.seed(seeds.at(k));
+        if(k > 0) {
+            evaluator = sharedEvaluator;
+            hasher = sharedHasher;
+        }
+        fitnessCache.clear();
+        localSearch.clear();
+
+        vector<double> championFitnessRecord;
+        StopCondition stopCondition(TIME_BUDGET_MS, STAGNATION_EPOCHS, lowerBound);
+        Population population;
+        initPopulation(population, taskList);
+        Migrant migrant; // 跨迁移复用
+
+        // 初始种群已达到下界时不迭代，其余岛屿随即停止
+        int epochs = EPOCH;
+        if(stopCondition.solvedAtStart(population.best(0).fitness)) {
+            solved.store(true, memory_order_relaxed);
+            epochs = 0;
+        }
+        for(int epo = 0; epo < epochs; epo++) {
+            if(STEADY_STATE)
+                evolveSteadyState(population);
+            else
+                evolve(population);
+
+            // 迁移
+            if((epo + 1) % MIGRATION_INTERVAL == 0) {
+                for(int to = 0; to < ISLAND_NUM; to++) {
+                    if(! channels.at(k * ISLAND_NUM + to))
+                        continue;
+                    for(int m = 0; m < MIGRANT_NUM && m < population.members.size(); m++) {
+                        const Chromosome& c = population.best(m);
+                        migrant.order.assign(c.order, c.order + c.n); // 线段树引用本线程的评估器，不随个体迁出，由接收方重建
+                        migrant.fitness = c.fitness;
+                        migrant.fingerprint = c.fingerprint;
+                        channels.at(k * ISLAND_NUM + to)->push(migrant); // 队列满时丢弃
+                    }
+                }
+                for(int from = 0; from < ISLAND_NUM; from++) {
+                    if(! channels.at(from * ISLAND_NUM + k))
+                        continue;
+                    while(channels.at(from * ISLAND_NUM + k)->pop(migrant)) {
+                        int r = population.acquire();
+                        Chromosome& c = population.slots[r];
+                        copy(migrant.order.begin(), migrant.order.end(), c.order);
+                        c.fitness = migrant.fitness;
+                        c.fingerprint = migrant.fingerprint;
+                        c.scored = migrant.fingerprint; // fitness由迁出方计算
+                        population.members.emplace_back(r);
+                    }
+                }
+                if(STEADY_STATE) { // 迁入个体与原有个体一起淘汰最差者
+                    population.heapify();
+                    while(population.members.size() > POP_SIZE)
+                        population.removeWorst();
+                }
+                else
+                    population.sort();
+            }
+
+            championFitnessRecord.emplace_back(population.best(0).fitness);
+            if(solved.load(memory_order_relaxed)) { // 其他岛屿已达到下界
+                stopCondition.reason = STOP_BOUND;
+                stopCondition.stopEpoch = epo + 1;
+                break;
+            }
+            if(stopCondition.shouldStop(epo + 1, championFitnessRecord)) {
+                if(stopCondition.reason == STOP_BOUND)
+                    solved.store(true, memory_order_relaxed);
+                break;
+            }
+        }
+
+        results.at(k) = IslandResult {population.best(0).fitness, stopCondition.reason, stopCondition.stopEpoch,
+                                      fitnessCache.hits.load(), fitnessCache.misses.load(), fitnessCache.skipped.load(),
+                                      localSearch.moves};
+    };
+    vector<thread> islands;
+    for(int k=1; k<ISLAND_NUM; k++)
+        islands.emplace_back(runIsland, k);
+    runIsland(0);
+    for(auto i = islands.begin(); i != islands.end(); i++)
+        (*i).join();
+    fitnessCache.clear(); // 岛屿0的计数已存入results，由调用方与其余岛屿一起汇总
+    localSearch.clear();
+    return results;
+}
+
+// 单次运行，返回记录行
+string runInstance(const SweepJob& job) {
+    rand_eng.seed(job.seed); // 每次运行使用独立的随机数序列
+    string resultReport = "";
 
     // 读取任务序列
-    vector<Task> taskList = readInstanceFile("./TestInstances/" + *it_n + "/" + *it_n + "_" + *it_id + ".txt");
+    vector<Task> taskList = readInstanceFile("./TestInstances/" + job.taskNum + "/" + job.taskNum + "_" + job.instanceId + ".txt");
+    evaluator.build(taskList, R(POWER), F); // 预计算传输时间和执行时间
+    hasher.build(taskList.size());
+    fitnessCache.clear();
+    localSearch.clear();
+    LowerBound lowerBound(evaluator); // 实例的下界，只计算一次，用于提前停止和计算差距
 
     // 记录历代最优值
     vector<double> championFitnessRecord;
@@ -175,45 +615,47 @@ for(int i_r = 0; i_r < iRepeatTimes; i_r++) { // 实例重复测试开始
     // 开始计时
     struct timeval startTime;
     mingw_gettimeofday(&startTime, NULL);
-
-    // 初始化种群
-    vector<Chromosome> population;
-    Chromosome championChromosome;
-    championChromosome.fitness = INT_MAX;
-    for(int i=0; i<POP_SIZE; i++) {
-        shuffle(taskList.begin(), taskList.end(), rand_eng); // 随机个体
-        population.emplace_back( Chromosome(taskList) ); // 列入种群，自动计算适应度
-    }
-    // 初始设置历史最佳
-    sort( population.begin(), population.end(), [](Chromosome a, Chromosome b){return a.fitness < b.fitness;} );
-    championChromosome = population.at(0);
-
-    // 遗传算法迭代
-    for(int epo = 0; epo < EPOCH; epo++) {
-        
-        // 选择
-        while(population.size() > POP_SIZE) {
-            population.pop_back(); // 已经按fitness升序排序，末位淘汰
-        }
-
-        // 交叉
-        for(int i = 0; i < population.size() - 1; i+=2) {
-            population.emplace_back(crossover(population.at(i), population.at(i+1)));
-        }
-
-        // 变异
-        for(auto i = population.begin(); i != population.end(); i++) {
-            uniform_real_distribution<double> rand_real(0.0, 1.0);
-            double mutateOrNot = rand_real(rand_eng);
-            if(mutateOrNot < 0.15) {
-                mutate(*i);
+    StopCondition stopCondition(TIME_BUDGET_MS, STAGNATION_EPOCHS, lowerBound.value); // 停止条件，达到下界即停止
+
+    double championFitness = INT_MAX; // 历史最佳的适应度
+
+    if(ISLAND_NUM > 1) {
+        // 岛屿模型，取各岛屿中最好的个体，停止原因和代数取自该岛屿，缓存计数和局部搜索的移动数为各岛屿之和
+        vector<IslandResult> islandResults = runIslands(taskList, lowerBound.value);
+        for(auto i = islandResults.begin(); i != islandResults.end(); i++) {
+            if((*i).championFitness < championFitness) {
+                championFitness = (*i).championFitness;
+                stopCondition.reason = (*i).reason;
+                stopCondition.stopEpoch = (*i).stopEpoch;
             }
+            fitnessCache.hits += (*i).cacheHits;
+            fitnessCache.misses += (*i).cacheMisses;
+            fitnessCache.skipped += (*i).skippedEvaluations;
+            localSearch.moves += (*i).localSearchMoves;
+        }
+    }
+    else {
+        // 初始化种群，初始设置历史最佳
+        Population population;
+        initPopulation(population, taskList);
+        championFitness = population.best(0).fitness;
+
+        // 遗传算法迭代，初始解已达到下界时不迭代
+        int epochs = stopCondition.solvedAtStart(championFitness) ? 0 : EPOCH;
+        for(int epo = 0; epo < epochs; epo++) {
+            if(STEADY_STATE)
+                evolveSteadyState(population);
+            else
+                evolve(population);
+
+            // 更新历史最佳
+            championFitness = population.best(0).fitness;
+            championFitnessRecord.emplace_back(championFitness);
+
+            // 检查停止条件
+            if(stopCondition.shouldStop(epo + 1, championFitnessRecord))
+                break;
         }
-
-        // 更新历史最佳
-        sort( population.begin(), population.end(), [](Chromosome a, Chromosome b){return a.fitness < b.fitness;} );
-        championChromosome = population.at(0);
-        championFitnessRecord.emplace_back(championChromosome.fitness);
     }
 
     // 停止计时
@@ -223,27 +665,44 @@ for(int i_r = 0; i_r < iRepeatTimes; i_r++) { // 实例重复测试开始
     double duration = (endTime.tv_sec - startTime.tv_sec)*1000.0 + (endTime.tv_usec - startTime.tv_usec)/1000.0;
 
     // 记录信息
-    resultReport += *it_n + "\t"; // 任务数量
-    resultReport += *it_id + '\t'; // 测试实例编号
-    resultReport += to_string(i_r) + "\t"; // 重复测试次数
-    resultReport += to_string(championChromosome.fitness) + "\t"; // 最优makespan
+    resultReport += job.taskNum + "\t"; // 任务数量
+    resultReport += job.instanceId + '\t'; // 测试实例编号
+    resultReport += to_string(job.repeat) + "\t"; // 重复测试次数
+    resultReport += to_string(championFitness) + "\t"; // 最优makespan
     resultReport += to_string(duration) + "\t"; // 运行时间
+    resultReport += to_string(fitnessCache.hits.load()) + "\t"; // 适应度缓存命中次数
+    resultReport += to_string(fitnessCache.misses.load()) + "\t"; // 适应度缓存未命中次数
+    resultReport += to_string(fitnessCache.skipped.load()) + "\t"; // 任务序列未变而跳过的计算次数
+    resultReport += to_string(lowerBound.value) + "\t"; // makespan的下界
+    resultReport += to_string(championFitness / lowerBound.value - 1.0) + "\t"; // 与下界的相对差距
+    resultReport += string(stopCondition.reasonName()) + "\t"; // 停止原因
+    resultReport += to_string(stopCondition.stopEpoch) + "\t"; // 停止时的代数
+    resultReport += to_string(localSearch.moves) + "\t"; // 局部搜索接受的移动数
     resultReport += "\n";
+    return resultReport;
+}
 
-    // 控制台输出日志
-    time_t time_t_now = time(nullptr);
-    char* timeStamp = ctime(&time_t_now);
-    timeStamp[strlen(timeStamp) - 1] = 0;
-    cout << "[" << timeStamp <<"] ";
-    cout << "Completed Instance " + *it_n + "_" + *it_id + "_" + to_string(i_r) + ".\n";
+int main(int argc, char* argv[]) {
+    // 可选参数：交叉算子名称（OX、PMX、CX、ERX、POS）
+    if(argc > 1 && ! parseCrossoverType(argv[1], crossoverType)) {
+        cerr << "Unknown crossover: " << argv[1] << endl;
+        return 1;
+    }
+
+// 实例测试
+vector<string> iTN {"10", "20", "30", "40", "50", "60", "70", "80", "90", "100"}; // 实例任务数量
+vector<string> iID {"0", "1", "2", "3", "4", "5", "6", "7", "8", "9"}; // 实例编号
+int iRepeatTimes = 5; // 每个实例重复次数
 
-} // 实例重复测试结束
-} // 实例编号循环结束
-} // 实例任务数量循环结束
+    // 并行运行全部实例，按原顺序汇总
+    string resultReport = runSweep(iTN, iID, iRepeatTimes, time(0), runInstance);
 
     // 写入输出文件
     ofstream fileOut;
-    fileOut.open("./Test Result - GA.txt");
+    if(crossoverType == CROSSOVER_OX)
+        fileOut.open("./Test Result - GA.txt");
+    else
+        fileOut.open("./Test Result - GA (" + string(crossoverName(crossoverType)) + ").txt");
     fileOut << resultReport;
     fileOut.close();
 
@@ -8,6 +8,18 @@
 #include <math.h>
 #include <time.h>
 #include <random>
+#if defined(__AVX2__) || defined(__AVX512F__)
+#include <immintrin.h>
+#endif
+#include "Makespan.h"
+#include "FitnessCache.h"
+#include "Population.h"
+#include "LowerBound.h"
+#include "StopCondition.h"
+#include "LocalSearch.h"
+#include "SweepRunner.h"
+#include "Scheduler.h"
+#include "Argsort.h"
 using namespace std;
 
 #define W 5000000.0 // 信道带宽（Hz）
@@ -24,7 +36,12 @@ using namespace std;
 #define MIN_POS 0.0 // 位置下限
 #define MAX_POS 4.0 // 位置上限
 
-default_random_engine rand_eng(time(0)); // 随机数
+// 单次运行的状态，各线程独立
+thread_local default_random_engine rand_eng(time(0)); // 随机数
+thread_local MakespanEvaluator evaluator; // 当前实例的makespan评估器
+thread_local PermutationHasher hasher; // 任务序列指纹
+thread_local FitnessCache fitnessCache; // 适应度缓存
+thread_local LocalSearch localSearch; // 精英个体的局部搜索
 
 // 由发射功率计算任务传输速率
 double R(double power) {
@@ -46,19 +63,28 @@ class Task {
 class Wolf {
     public:
         int id;
-        vector<Task> taskList;
+        TaskIndex* order; // 任务序列，指向arena中的一行
+        int n; // 任务数
         vector<double> position; // 位置信息，用于ROV Mapping
         double fitness;
+        uint64_t fingerprint; // 任务序列指纹
+        uint64_t scored; // 当前fitness所对应的指纹，与fingerprint相同时任务序列未变，不必重新计算
+        default_random_engine rng; // 个体独立的随机数序列，并行更新时结果与线程数无关
 
         double calcFitness(); // 计算fitness，见下文
+        void move(const vector<double>& target, double A, double C); // 更新位置，见下文
         void ROV(); // ROV Mapping，见下文
+        void assign(const Wolf& other);
 
-        Wolf(int id, vector<Task> taskList) {
+        // order须已填入任务序列
+        Wolf(int id, TaskIndex* order, int n) {
             this->id = id;
-            this->taskList = taskList;
+            this->rng.seed(rand_eng());
+            this->order = order;
+            this->n = n;
             // 自动生成随机位置信息
             uniform_real_distribution<double> rand_real(MIN_POS, MAX_POS);
-            for(int i=0; i<taskList.size(); i++) {
+            for(int i=0; i<n; i++) {
                 this->position.emplace_back(rand_real(rand_eng));
             }
             ROV(); // 生成随机任务序列
@@ -66,47 +92,78 @@ class Wolf {
         }
         Wolf() { // 默认无参构造函数，用于声明alpha、beta、gamma狼
             this->id = -1;
+            this->order = nullptr;
+            this->n = 0;
             this->fitness = INT_MAX;
+            this->fingerprint = 0;
+            this->scored = 1; // 与fingerprint不同，即fitness尚未计算
         }
 };
 // 计算fitness（makespan）
 double Wolf::calcFitness() {
-    vector<double> t_ready, t_complete;
-    double sum_dataSize = 0.0; // 前i个任务的数据量和
-    for(auto i = taskList.begin(); i != taskList.end(); i++) {
-        sum_dataSize += (*i).dataSize; // 前i个任务的数据量和
-        t_ready.emplace_back(sum_dataSize / R(POWER)); // 第i个任务的准备时间
-        double t_dispose_i = (*i).cyclePerBit * (*i).dataSize / F; // 第i个任务的执行时间
-        // 第i个任务的完成时间
-        if(i == taskList.begin()) {
-            assert(t_complete.empty()); // i=1
-            t_complete.emplace_back( *(t_ready.rbegin()) + t_dispose_i ); // t_ready_i + t_dispose_i
+    fingerprint = hasher.hash(order, n);
+    scored = fingerprint;
+    return fitnessCache.fetch(fingerprint, [this]{ return evaluator.makespan(order, n); }); // 先查缓存
+}
+// 更新位置：newPosition = target - A * |C * target - position|，并限制在[MIN_POS, MAX_POS]
+// 编译时加-mavx2或-mavx512f时每条指令更新4 / 8维
+void Wolf::move(const vector<double>& target, double A, double C) {
+    const double* t = target.data();
+    double* p = position.data();
+    int j = 0;
+#if defined(__AVX512F__)
+    {
+        __m512d vA = _mm512_set1_pd(A), vC = _mm512_set1_pd(C);
+        __m512d vMin = _mm512_set1_pd(MIN_POS), vMax = _mm512_set1_pd(MAX_POS);
+        for(; j + 8 <= n; j += 8) {
+            __m512d vt = _mm512_loadu_pd(t + j);
+            __m512d dist = _mm512_abs_pd(_mm512_sub_pd(_mm512_mul_pd(vC, vt), _mm512_loadu_pd(p + j)));
+            __m512d newPosition = _mm512_sub_pd(vt, _mm512_mul_pd(vA, dist));
+            _mm512_storeu_pd(p + j, _mm512_max_pd(_mm512_min_pd(newPosition, vMax), vMin));
         }
-        else {
-            assert( ! t_complete.empty()); // i>1
-            double t_ready_i = *(t_ready.rbegin()), t_complete_i_1 = *(t_complete.rbegin());
-            t_complete.emplace_back(
-                (t_ready_i > t_complete_i_1 ? t_ready_i : t_complete_i_1) + t_dispose_i
-            ); // max{t_ready_i, t_complete_(i-1)} + t_dispose_i
+    }
+#endif
+#if defined(__AVX2__)
+    {
+        __m256d vA = _mm256_set1_pd(A), vC = _mm256_set1_pd(C);
+        __m256d vMin = _mm256_set1_pd(MIN_POS), vMax = _mm256_set1_pd(MAX_POS);
+        const __m256d signMask = _mm256_set1_pd(-0.0);
+        for(; j + 4 <= n; j += 4) {
+            __m256d vt = _mm256_loadu_pd(t + j);
+            __m256d dist = _mm256_andnot_pd(signMask, _mm256_sub_pd(_mm256_mul_pd(vC, vt), _mm256_loadu_pd(p + j)));
+            __m256d newPosition = _mm256_sub_pd(vt, _mm256_mul_pd(vA, dist));
+            _mm256_storeu_pd(p + j, _mm256_max_pd(_mm256_min_pd(newPosition, vMax), vMin));
         }
     }
-
-    assert(t_complete.size() == taskList.size());
-    return *(max_element(t_complete.begin(), t_complete.end()));
+#endif
+    for(; j<n; j++) { // 以下标顺序遍历
+        double Dist = fabs(C * t[j] - p[j]);
+        double newPosition = t[j] - A * Dist;
+        // 界限检查
+        if(newPosition < MIN_POS)
+            newPosition = MIN_POS;
+        if(newPosition > MAX_POS)
+            newPosition = MAX_POS;
+        p[j] = newPosition;
+    }
 }
-// ROV Mapping，更新任务序列
+// ROV Mapping，按位置升序重排任务序列，位置相同时下标小的在前
 void Wolf::ROV() {
-    vector<pair<double, int>> rankedPosition; // 位置信息副本用于排序，不破坏原有的下标顺序
-    for(int i=0; i<position.size(); i++)
-        rankedPosition.emplace_back(pair<double, int> (position.at(i), i));
-    sort(rankedPosition.begin(), rankedPosition.end(),
-        []( pair<double, int> a, pair<double, int> b ){ return a.first < b.first; }
-    ); // 排序
-    vector<Task> newTaskList;
-    for(auto i = rankedPosition.begin(); i != rankedPosition.end(); i++) {
-        newTaskList.emplace_back(this->taskList.at( (*i).second ));
-    } // 取对应下标
-    this->taskList = newTaskList;
+    static thread_local vector<int> rank; // 位置升序的下标，跨调用复用
+    static thread_local vector<TaskIndex> oldOrder;
+    rank.resize(n);
+    argsort(position.data(), n, rank.data());
+    oldOrder.assign(order, order + n);
+    for(int k=0; k<n; k++)
+        order[k] = oldOrder[rank[k]]; // 取对应下标
+}
+// 把另一个个体的任务序列、位置和适应度复制到本个体，用于保存前三名和历史最佳
+void Wolf::assign(const Wolf& other) {
+    copy(other.order, other.order + n, order);
+    position = other.position;
+    fitness = other.fitness;
+    fingerprint = other.fingerprint;
+    scored = other.scored;
 }
 
 // 读取Instance文件，格式：id - dataSize - cyclePerBit
@@ -127,20 +184,18 @@ vector<Task> readInstanceFile(string fileDir) {
     return taskList;
 }
 
-int main() {
+// 单次运行，返回记录行
+string runInstance(const SweepJob& job) {
+    rand_eng.seed(job.seed); // 每次运行使用独立的随机数序列
     string resultReport = "";
 
-// 实例测试
-vector<string> iTN {"10", "20", "30", "40", "50", "60", "70", "80", "90", "100"}; // 实例任务数量
-vector<string> iID {"0", "1", "2", "3", "4", "5", "6", "7", "8", "9"}; // 实例编号
-int iRepeatTimes = 5; // 每个实例重复次数
-
-for(auto it_n = iTN.begin(); it_n != iTN.end(); it_n++) { // 实例任务数量循环开始
-for(auto it_id = iID.begin(); it_id != iID.end(); it_id++) { // 实例编号循环开始
-for(int i_r = 0; i_r < iRepeatTimes; i_r++) { // 实例重复测试开始
-
     // 读取任务序列
-    vector<Task> taskList = readInstanceFile("./TestInstances/" + *it_n + "/" + *it_n + "_" + *it_id + ".txt");
+    vector<Task> taskList = readInstanceFile("./TestInstances/" + job.taskNum + "/" + job.taskNum + "_" + job.instanceId + ".txt");
+    evaluator.build(taskList, R(POWER), F); // 预计算传输时间和执行时间
+    hasher.build(taskList.size());
+    fitnessCache.clear();
+    localSearch.clear();
+    LowerBound lowerBound(evaluator); // 实例的下界，只计算一次，用于提前停止和计算差距
 
     // 记录历代最优值
     vector<double> championFitnessRecord;
@@ -148,65 +203,85 @@ for(int i_r = 0; i_r < iRepeatTimes; i_r++) { // 实例重复测试开始
     // 开始计时
     struct timeval startTime;
     mingw_gettimeofday(&startTime, NULL);
+    StopCondition stopCondition(TIME_BUDGET_MS, STAGNATION_EPOCHS, lowerBound.value); // 停止条件，达到下界即停止
 
-    // 初始化灰狼种群
+    // 初始化灰狼种群，任务序列存放在arena中，第POP_SIZE ~ POP_SIZE+3行存放前三名和历史最佳
+    int n = taskList.size();
+    PermutationArena arena;
+    arena.build(POP_SIZE + 4, n);
     vector<Wolf> population;
+    population.reserve(POP_SIZE);
     Wolf alphaWolf, betaWolf, deltaWolf, championWolf;
     assert(championWolf.fitness == INT_MAX);
-    for(int i=0; i<POP_SIZE; i++)
-        population.emplace_back( Wolf(i, taskList) ); // 将个体加入种群
-    // 初始设置前三名和历史最佳
-    sort( population.begin(), population.end(), [](Wolf a, Wolf b){return a.fitness < b.fitness;} );
-    alphaWolf = population.at(0);
-    betaWolf = population.at(1);
-    deltaWolf = population.at(2);
+    Wolf* copies[4] = {&alphaWolf, &betaWolf, &deltaWolf, &championWolf}; // 前三名和历史最佳的副本
+    for(int k=0; k<4; k++) {
+        (*copies[k]).order = arena.row(POP_SIZE + k);
+        (*copies[k]).n = n;
+    }
+    for(int i=0; i<POP_SIZE; i++) {
+        TaskIndex* order = arena.row(i);
+        for(int j=0; j<n; j++)
+            order[j] = taskList[j].id;
+        population.emplace_back( Wolf(i, order, n) ); // 将个体加入种群
+    }
+    // 初始设置前三名和历史最佳，按下标排名，个体本身不移动
+    vector<int> rank;
+    rankByFitness(population, rank);
+    alphaWolf.assign(population.at(rank.at(0)));
+    betaWolf.assign(population.at(rank.at(1)));
+    deltaWolf.assign(population.at(rank.at(2)));
     if(alphaWolf.fitness < championWolf.fitness)
-        championWolf = alphaWolf;
+        championWolf.assign(alphaWolf);
     championFitnessRecord.emplace_back(championWolf.fitness);
     // 初始设置目标位置
     vector<double> targetPosition;
     for(int i=0; i<taskList.size(); i++)
         targetPosition.emplace_back( (alphaWolf.position.at(i) + betaWolf.position.at(i) + deltaWolf.position.at(i)) / 3.0 );
 
-    // 灰狼算法迭代
-    for(int epo = 0; epo < EPOCH; epo++) {
-        // 对于种群中的每一个个体
-        for(auto i = population.begin(); i != population.end(); i++) {
-            // 更新参数
-            uniform_real_distribution<double> rand_real(0.0, 1.0); // [0, 1]区间内的随机数
-            double r_1 = rand_real(rand_eng);
-            double r_2 = rand_real(rand_eng);
-            double a = 2.0 * (1 - epo/EPOCH);
-            double A = a * (2.0 * r_1 - 1.0);
-            double C = 2.0 * r_2;
-
-            // 更新位置
-            for(int j=0; j<(*i).position.size(); j++) { // 以下标顺序遍历
-                double Dist = abs(C * targetPosition.at(j) - (*i).position.at(j));
-                double newPosition = targetPosition.at(j) - A * Dist;
-                // 界限检查
-                if(newPosition < MIN_POS)
-                    newPosition = MIN_POS;
-                if(newPosition > MAX_POS)
-                    newPosition = MAX_POS;
-                (*i).position.at(j) = newPosition;
+    // 子任务可能被其他线程窃取执行，通过引用使用本次运行的状态
+    const MakespanEvaluator& runEvaluator = evaluator;
+    const PermutationHasher& runHasher = hasher;
+    FitnessCache& runCache = fitnessCache;
+
+    // 灰狼算法迭代，初始解已达到下界时不迭代
+    int epochs = stopCondition.solvedAtStart(championWolf.fitness) ? 0 : EPOCH;
+    for(int epo = 0; epo < epochs; epo++) {
+        // 并行更新每一个个体，只读取targetPosition
+        scheduler().parallelFor(population.size(), [&](int begin, int end) {
+            for(auto i = population.begin() + begin; i != population.begin() + end; i++) {
+                // 更新参数
+                uniform_real_distribution<double> rand_real(0.0, 1.0); // [0, 1]区间内的随机数
+                double r_1 = rand_real((*i).rng);
+                double r_2 = rand_real((*i).rng);
+                double a = 2.0 * (1 - epo/EPOCH);
+                double A = a * (2.0 * r_1 - 1.0);
+                double C = 2.0 * r_2;
+
+                // 更新位置
+                (*i).move(targetPosition, A, C);
+
+                // 映射任务序列
+                (*i).ROV();
+                (*i).fingerprint = runHasher.hash((*i).order, n);
             }
 
-            // 映射任务序列
-            (*i).ROV();
-
-            // 更新fitness
-            (*i).fitness = (*i).calcFitness();
-        }
+            // 批量更新本块的fitness，跳过任务序列未变的个体，只计算缓存未命中的个体
+            evaluatePopulation(runEvaluator, runCache, population.data() + begin, end - begin);
+        });
 
         // 更新前三名和历史最佳
-        sort( population.begin(), population.end(), [](Wolf a, Wolf b){return a.fitness < b.fitness;} );
-        alphaWolf = population.at(0);
-        betaWolf = population.at(1);
-        deltaWolf = population.at(2);
+        rankByFitness(population, rank);
+        polishElites(localSearch, evaluator, population, rank); // 精英个体局部搜索
+        alphaWolf.assign(population.at(rank.at(0)));
+        betaWolf.assign(population.at(rank.at(1)));
+        deltaWolf.assign(population.at(rank.at(2)));
         if(alphaWolf.fitness < championWolf.fitness)
-            championWolf = alphaWolf;
+            championWolf.assign(alphaWolf);
         championFitnessRecord.emplace_back(championWolf.fitness);
+
+        // 检查停止条件
+        if(stopCondition.shouldStop(epo + 1, championFitnessRecord))
+            break;
     }
 
     // 停止计时
@@ -216,23 +291,31 @@ for(int i_r = 0; i_r < iRepeatTimes; i_r++) { // 实例重复测试开始
     double duration = (endTime.tv_sec - startTime.tv_sec)*1000.0 + (endTime.tv_usec - startTime.tv_usec)/1000.0;
 
     // 记录信息
-    resultReport += *it_n + "\t"; // 任务数量
-    resultReport += *it_id + '\t'; // 测试实例编号
-    resultReport += to_string(i_r) + "\t"; // 重复测试次数
+    resultReport += job.taskNum + "\t"; // 任务数量
+    resultReport += job.instanceId + '\t'; // 测试实例编号
+    resultReport += to_string(job.repeat) + "\t"; // 重复测试次数
     resultReport += to_string(championWolf.fitness) + "\t"; // 最优makespan
     resultReport += to_string(duration) + "\t"; // 运行时间
+    resultReport += to_string(fitnessCache.hits.load()) + "\t"; // 适应度缓存命中次数
+    resultReport += to_string(fitnessCache.misses.load()) + "\t"; // 适应度缓存未命中次数
+    resultReport += to_string(fitnessCache.skipped.load()) + "\t"; // 任务序列未变而跳过的计算次数
+    resultReport += to_string(lowerBound.value) + "\t"; // makespan的下界
+    resultReport += to_string(championWolf.fitness / lowerBound.value - 1.0) + "\t"; // 与下界的相对差距
+    resultReport += string(stopCondition.reasonName()) + "\t"; // 停止原因
+    resultReport += to_string(stopCondition.stopEpoch) + "\t"; // 停止时的代数
+    resultReport += to_string(localSearch.moves) + "\t"; // 局部搜索接受的移动数
     resultReport += "\n";
+    return resultReport;
+}
 
-    // 控制台输出日志
-    time_t time_t_now = time(nullptr);
-    char* timeStamp = ctime(&time_t_now);
-    timeStamp[strlen(timeStamp) - 1] = 0;
-    cout << "[" << timeStamp <<"] ";
-    cout << "Completed Instance " + *it_n + "_" + *it_id + "_" + to_string(i_r) + ".\n";
+int main() {
+// 实例测试
+vector<string> iTN {"10", "20", "30", "40", "50", "60", "70", "80", "90", "100"}; // 实例任务数量
+vector<string> iID {"0", "1", "2", "3", "4", "5", "6", "7", "8", "9"}; // 实例编号
+int iRepeatTimes = 5; // 每个实例重复次数
 
-} // 实例重复测试结束
-} // 实例编号循环结束
-} // 实例任务数量循环结束
+    // 并行运行全部实例，按原顺序汇总
+    string resultReport = runSweep(iTN, iID, iRepeatTimes, time(0), runInstance);
 
     // 写入输出文件
     ofstream fileOut;
@@ -8,6 +8,16 @@
 #include <math.h>
 #include <time.h>
 #include <random>
+#include "Makespan.h"
+#include "MakespanTree.h"
+#include "FitnessCache.h"
+#include "Population.h"
+#include "SwapSequence.h"
+#include "LowerBound.h"
+#include "StopCondition.h"
+#include "LocalSearch.h"
+#include "SweepRunner.h"
+#include "Scheduler.h"
 using namespace std;
 
 #define W 5000000.0 // 信道带宽（Hz）
@@ -22,7 +32,12 @@ using namespace std;
 #define EPOCH 1000 // 迭代次数
 #define POWER 5.0 // 发射功率（mW）
 
-default_random_engine rand_eng(time(0)); // 随机数
+// 单次运行的状态，各线程独立
+thread_local default_random_engine rand_eng(time(0)); // 随机数
+thread_local MakespanEvaluator evaluator; // 当前实例的makespan评估器
+thread_local PermutationHasher hasher; // 任务序列指纹
+thread_local FitnessCache fitnessCache; // 适应度缓存
+thread_local LocalSearch localSearch; // 精英个体的局部搜索
 
 // 由发射功率计算任务传输速率
 double R(double power) {
@@ -44,66 +59,63 @@ class Task {
 class Wolf {
     public:
         int id;
-        vector<Task> taskList;
+        TaskIndex* order; // 任务序列，指向arena中的一行
+        int n; // 任务数
         double fitness;
+        uint64_t fingerprint; // 任务序列指纹
+        uint64_t scored; // 当前fitness所对应的指纹，与fingerprint相同时任务序列未变，不必重新计算
+        default_random_engine rng; // 个体独立的随机数序列，并行更新时结果与线程数无关
+        MakespanTree tree; // 用于应用变换序列后增量更新适应度
 
         double calcFitness();
+        void applySwap(const pair<int, int>& s, const PermutationHasher& hasher);
+        void refreshFitness(FitnessCache& cache);
+        void assign(const Wolf& other);
 
-        Wolf(int id, vector<Task> taskList) {
+        // order须已填入任务序列
+        Wolf(int id, TaskIndex* order, int n) {
             this->id = id;
-            this->taskList = taskList;
+            this->rng.seed(rand_eng());
+            this->order = order;
+            this->n = n;
             this->fitness = calcFitness(); // 自动计算适应度
         }
         Wolf() {
             this->id = -1;
+            this->order = nullptr;
+            this->n = 0;
             this->fitness = INT_MAX;
+            this->fingerprint = 0;
+            this->scored = 1; // 与fingerprint不同，即fitness尚未计算
         }
 };
 // 计算fitness（makespan）
 double Wolf::calcFitness() {
-    vector<double> t_ready, t_complete;
-    double sum_dataSize = 0.0; // 前i个任务的数据量和
-    for(auto i = taskList.begin(); i != taskList.end(); i++) {
-        sum_dataSize += (*i).dataSize; // 前i个任务的数据量和
-        t_ready.emplace_back(sum_dataSize / R(POWER)); // 第i个任务的准备时间
-        double t_dispose_i = (*i).cyclePerBit * (*i).dataSize / F; // 第i个任务的执行时间
-        // 第i个任务的完成时间
-        if(i == taskList.begin()) {
-            assert(t_complete.empty()); // i=1
-            t_complete.emplace_back( *(t_ready.rbegin()) + t_dispose_i ); // t_ready_i + t_dispose_i
-        }
-        else {
-            assert( ! t_complete.empty()); // i>1
-            double t_ready_i = *(t_ready.rbegin()), t_complete_i_1 = *(t_complete.rbegin());
-            t_complete.emplace_back(
-                (t_ready_i > t_complete_i_1 ? t_ready_i : t_complete_i_1) + t_dispose_i
-            ); // max{t_ready_i, t_complete_(i-1)} + t_dispose_i
-        }
-    }
-
-    assert(t_complete.size() == taskList.size());
-    return *(max_element(t_complete.begin(), t_complete.end()));
+    tree.build(evaluator, order, n); // 同时重建线段树
+    fingerprint = hasher.hash(order, n);
+    scored = fingerprint;
+    return fitnessCache.fetch(fingerprint, [this]{ return tree.makespan(); });
 }
-
-// 计算变换序列
-vector<pair<int, int>> calcSwapSequence(const vector<Task>& from, const vector<Task>& to) {
-    assert(from.size() == to.size());
-    vector<pair<int, int>> swapSequence;
-    auto emul = from; // 使用副本模拟变换，保证原序列不受影响
-    
-    for(int i=0; i<to.size(); i++) {
-        for(int j=i; j<emul.size(); j++) {
-            if(emul.at(j).id == to.at(i).id) { // 需取出Task的id进行比较
-                if(i != j) { // 在同一位置则不需要变化
-                    swapSequence.emplace_back(pair<int, int> (i, j));
-                    swap(emul.at(i), emul.at(j));
-                }
-                break;
-            }
-        }
-    }
-
-    return swapSequence;
+// 应用一次交换，线段树暂不更新
+void Wolf::applySwap(const pair<int, int>& s, const PermutationHasher& hasher) {
+    fingerprint += hasher.swapDelta(s.first, s.second, order[s.first], order[s.second]);
+    swap(order[s.first], order[s.second]);
+    tree.markSwap(s.first, s.second);
+}
+// 更新fitness：任务序列未变（未应用交换或交换相互抵消）时跳过，线段树中待更新的交换留到下次
+// 否则先查缓存，未命中时由线段树更新，代价为O(min(k log n, n))，k为应用的交换数
+void Wolf::refreshFitness(FitnessCache& cache) {
+    if(cache.unchanged(fingerprint, scored))
+        return;
+    scored = fingerprint;
+    fitness = cache.fetch(fingerprint, [this]{ tree.flush(); return tree.makespan(); });
+}
+// 把另一个个体的任务序列和适应度复制到本个体的行，用于保存前三名和历史最佳
+void Wolf::assign(const Wolf& other) {
+    copy(other.order, other.order + n, order);
+    fitness = other.fitness;
+    fingerprint = other.fingerprint;
+    scored = other.scored;
 }
 
 // 读取Instance文件，格式：id - dataSize - cyclePerBit
@@ -124,20 +136,18 @@ vector<Task> readInstanceFile(string fileDir) {
     return taskList;
 }
 
-int main() {
+// 单次运行，返回记录行
+string runInstance(const SweepJob& job) {
+    rand_eng.seed(job.seed); // 每次运行使用独立的随机数序列
     string resultReport = "";
 
-// 实例测试
-vector<string> iTN {"10", "20", "30", "40", "50", "60", "70", "80", "90", "100"}; // 实例任务数量
-vector<string> iID {"0", "1", "2", "3", "4", "5", "6", "7", "8", "9"}; // 实例编号
-int iRepeatTimes = 5; // 每个实例重复次数
-
-for(auto it_n = iTN.begin(); it_n != iTN.end(); it_n++) { // 实例任务数量循环开始
-for(auto it_id = iID.begin(); it_id != iID.end(); it_id++) { // 实例编号循环开始
-for(int i_r = 0; i_r < iRepeatTimes; i_r++) { // 实例重复测试开始
-
     // 读取任务序列
-    vector<Task> taskList = readInstanceFile("./TestInstances/" + *it_n + "/" + *it_n + "_" + *it_id + ".txt");
+    vector<Task> taskList = readInstanceFile("./TestInstances/" + job.taskNum + "/" + job.taskNum + "_" + job.instanceId + ".txt");
+    evaluator.build(taskList, R(POWER), F); // 预计算传输时间和执行时间
+    hasher.build(taskList.size());
+    fitnessCache.clear();
+    localSearch.clear();
+    LowerBound lowerBound(evaluator); // 实例的下界，只计算一次，用于提前停止和计算差距
 
     // 记录历代最优值
     vector<double> championFitnessRecord;
@@ -145,67 +155,81 @@ for(int i_r = 0; i_r < iRepeatTimes; i_r++) { // 实例重复测试开始
     // 开始计时
     struct timeval startTime;
     mingw_gettimeofday(&startTime, NULL);
+    StopCondition stopCondition(TIME_BUDGET_MS, STAGNATION_EPOCHS, lowerBound.value); // 停止条件，达到下界即停止
 
     // 初始化灰狼种群
+    // 任务序列存放在arena中，第POP_SIZE ~ POP_SIZE+3行存放前三名和历史最佳
+    int n = taskList.size();
+    PermutationArena arena;
+    arena.build(POP_SIZE + 4, n);
     vector<Wolf> population;
+    population.reserve(POP_SIZE);
     Wolf alphaWolf, betaWolf, deltaWolf, championWolf;
+    Wolf* copies[4] = {&alphaWolf, &betaWolf, &deltaWolf, &championWolf}; // 前三名和历史最佳的副本
+    for(int k=0; k<4; k++) {
+        (*copies[k]).order = arena.row(POP_SIZE + k);
+        (*copies[k]).n = n;
+    }
     championWolf.fitness = INT_MAX;
     for(int i=0; i<POP_SIZE; i++) {
         shuffle(taskList.begin(), taskList.end(), rand_eng); // 随机个体
-        population.emplace_back( Wolf(i, taskList) ); // 列入种群，自动计算适应度
+        TaskIndex* order = arena.row(i);
+        for(int j=0; j<n; j++)
+            order[j] = taskList[j].id;
+        population.emplace_back( Wolf(i, order, n) ); // 列入种群，自动计算适应度
     }
     // 初始设置前三名和历史最佳
-    sort( population.begin(), population.end(), [](Wolf a, Wolf b){return a.fitness < b.fitness;} );
-    alphaWolf = population.at(0);
-    betaWolf = population.at(1);
-    deltaWolf = population.at(2);
+    vector<int> rank; // 按下标排名，个体本身不移动
+    rankByFitness(population, rank);
+    alphaWolf.assign(population.at(rank.at(0)));
+    betaWolf.assign(population.at(rank.at(1)));
+    deltaWolf.assign(population.at(rank.at(2)));
     if(alphaWolf.fitness < championWolf.fitness)
-        championWolf = alphaWolf;
-
-    // 灰狼算法迭代
-    for(int epo = 0; epo < EPOCH; epo++) {
-        // 对于种群中的每一个个体
-        for(auto i = population.begin(); i != population.end(); i++) {
-            // 更新参数
-            uniform_real_distribution<double> rand_real(0.0, 1.0);
-            double c_1 = rand_real(rand_eng);
-            double c_2 = rand_real(rand_eng);
-            double c_3 = rand_real(rand_eng);
-
-            // 更新位置
-            // 计算变换序列
-            auto alphaSwapSequence = calcSwapSequence((*i).taskList, alphaWolf.taskList);
-            auto betaSwapSequence = calcSwapSequence((*i).taskList, betaWolf.taskList);
-            auto deltaSwapSequence = calcSwapSequence((*i).taskList, deltaWolf.taskList);
-            
-            for(auto i_ss = alphaSwapSequence.begin(); i_ss != alphaSwapSequence.end(); i_ss++) {
-                if(rand_real(rand_eng) < c_1) {
-                    swap((*i).taskList.at((*i_ss).first), (*i).taskList.at((*i_ss).second));
-                }
-            }
-            for(auto i_ss = betaSwapSequence.begin(); i_ss != betaSwapSequence.end(); i_ss++) {
-                if(rand_real(rand_eng) < c_2) {
-                    swap((*i).taskList.at((*i_ss).first), (*i).taskList.at((*i_ss).second));
-                }
+        championWolf.assign(alphaWolf);
+
+    // 子任务可能被其他线程窃取执行，通过引用使用本次运行的状态
+    const PermutationHasher& runHasher = hasher;
+    FitnessCache& runCache = fitnessCache;
+
+    // 灰狼算法迭代，初始解已达到下界时不迭代
+    int epochs = stopCondition.solvedAtStart(championWolf.fitness) ? 0 : EPOCH;
+    for(int epo = 0; epo < epochs; epo++) {
+        // 并行更新每一个个体，只读取上一代的alphaWolf、betaWolf和deltaWolf
+        scheduler().parallelFor(population.size(), [&](int begin, int end) {
+            for(auto i = population.begin() + begin; i != population.begin() + end; i++) {
+                // 更新参数
+                uniform_real_distribution<double> rand_real(0.0, 1.0);
+                double c_1 = rand_real((*i).rng);
+                double c_2 = rand_real((*i).rng);
+                double c_3 = rand_real((*i).rng);
+
+                // 更新位置
+                // 变换序列均由更新前的位置计算，依次以概率c_1、c_2、c_3应用其中的交换，不生成序列
+                static thread_local vector<TaskIndex> origin; // 更新前的任务序列，跨调用复用
+                origin.assign((*i).order, (*i).order + n);
+                auto apply = [&](int a, int b) { (*i).applySwap(pair<int, int> (a, b), runHasher); };
+                applySwapSequence(origin.data(), alphaWolf.order, n, c_1, (*i).rng, apply);
+                applySwapSequence(origin.data(), betaWolf.order, n, c_2, (*i).rng, apply);
+                applySwapSequence(origin.data(), deltaWolf.order, n, c_3, (*i).rng, apply);
+
+                // 更新fitness
+                (*i).refreshFitness(runCache);
             }
-            for(auto i_ss = deltaSwapSequence.begin(); i_ss != deltaSwapSequence.end(); i_ss++) {
-                if(rand_real(rand_eng) < c_3) {
-                    swap((*i).taskList.at((*i_ss).first), (*i).taskList.at((*i_ss).second));
-                }
-            }
-
-            // 更新fitness
-            (*i).fitness = (*i).calcFitness();
-        }
+        });
 
         // 更新前三名和历史最佳
-        sort( population.begin(), population.end(), [](Wolf a, Wolf b){return a.fitness < b.fitness;} );
-        alphaWolf = population.at(0);
-        betaWolf = population.at(1);
-        deltaWolf = population.at(2);
+        rankByFitness(population, rank);
+        polishElites(localSearch, evaluator, population, rank); // 精英个体局部搜索
+        alphaWolf.assign(population.at(rank.at(0)));
+        betaWolf.assign(population.at(rank.at(1)));
+        deltaWolf.assign(population.at(rank.at(2)));
         if(alphaWolf.fitness < championWolf.fitness)
-            championWolf = alphaWolf;
+            championWolf.assign(alphaWolf);
         championFitnessRecord.emplace_back(championWolf.fitness);
+
+        // 检查停止条件
+        if(stopCondition.shouldStop(epo + 1, championFitnessRecord))
+            break;
     }
 
     // 停止计时
@@ -215,23 +239,31 @@ for(int i_r = 0; i_r < iRepeatTimes; i_r++) { // 实例重复测试开始
     double duration = (endTime.tv_sec - startTime.tv_sec)*1000.0 + (endTime.tv_usec - startTime.tv_usec)/1000.0;
 
     // 记录信息
-    resultReport += *it_n + "\t"; // 任务数量
-    resultReport += *it_id + '\t'; // 测试实例编号
-    resultReport += to_string(i_r) + "\t"; // 重复测试次数
+    resultReport += job.taskNum + "\t"; // 任务数量
+    resultReport += job.instanceId + '\t'; // 测试实例编号
+    resultReport += to_string(job.repeat) + "\t"; // 重复测试次数
     resultReport += to_string(championWolf.fitness) + "\t"; // 最优makespan
     resultReport += to_string(duration) + "\t"; // 运行时间
+    resultReport += to_string(fitnessCache.hits.load()) + "\t"; // 适应度缓存命中次数
+    resultReport += to_string(fitnessCache.misses.load()) + "\t"; // 适应度缓存未命中次数
+    resultReport += to_string(fitnessCache.skipped.load()) + "\t"; // 任务序列未变而跳过的计算次数
+    resultReport += to_string(lowerBound.value) + "\t"; // makespan的下界
+    resultReport += to_string(championWolf.fitness / lowerBound.value - 1.0) + "\t"; // 与下界的相对差距
+    resultReport += string(stopCondition.reasonName()) + "\t"; // 停止原因
+    resultReport += to_string(stopCondition.stopEpoch) + "\t"; // 停止时的代数
+    resultReport += to_string(localSearch.moves) + "\t"; // 局部搜索接受的移动数
     resultReport += "\n";
+    return resultReport;
+}
 
-    // 控制台输出日志
-    time_t time_t_now = time(nullptr);
-    char* timeStamp = ctime(&time_t_now);
-    timeStamp[strlen(timeStamp) - 1] = 0;
-    cout << "[" << timeStamp <<"] ";
-    cout << "Completed Instance " + *it_n + "_" + *it_id + "_" + to_string(i_r) + ".\n";
+int main() {
+// 实例测试
+vector<string> iTN {"10", "20", "30", "40", "50", "60", "70", "80", "90", "100"}; // 实例任务数量
+vector<string> iID {"0", "1", "2", "3", "4", "5", "6", "7", "8", "9"}; // 实例编号
+int iRepeatTimes = 5; // 每个实例重复次数
 
-} // 实例重复测试结束
-} // 实例编号循环结束
-} // 实例任务数量循环结束
+    // 并行运行全部实例，按原顺序汇总
+    string resultReport = runSweep(iTN, iID, iRepeatTimes, time(0), runInstance);
 
     // 写入输出文件
     ofstream fileOut;
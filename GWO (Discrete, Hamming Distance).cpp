@@ -7,6 +7,16 @@
 #include <math.h>
 #include <time.h>
 #include <random>
+#include "Makespan.h"
+#include "FitnessCache.h"
+#include "Population.h"
+#include "LowerBound.h"
+#include "StopCondition.h"
+#include "LocalSearch.h"
+#include "SweepRunner.h"
+#include "Scheduler.h"
+#include "Derangement.h"
+#include "Hamming.h"
 using namespace std;
 
 #define W 5000000.0 // 信道带宽（Hz）
@@ -21,7 +31,12 @@ using namespace std;
 #define EPOCH 1000 // 迭代次数
 #define POWER 5.0 // 发射功率（mW）
 
-default_random_engine rand_eng(time(0)); // 随机数
+// 单次运行的状态，各线程独立
+thread_local default_random_engine rand_eng(time(0)); // 随机数
+thread_local MakespanEvaluator evaluator; // 当前实例的makespan评估器
+thread_local PermutationHasher hasher; // 任务序列指纹
+thread_local FitnessCache fitnessCache; // 适应度缓存
+thread_local LocalSearch localSearch; // 精英个体的局部搜索
 
 // 由发射功率计算任务传输速率
 double R(double power) {
@@ -43,131 +58,58 @@ class Task {
 class Wolf {
     public:
         int id;
-        vector<Task> taskList;
+        TaskIndex* order; // 任务序列，指向arena中的一行
+        int n; // 任务数
         double fitness;
+        uint64_t fingerprint; // 任务序列指纹
+        uint64_t scored; // 当前fitness所对应的指纹，与fingerprint相同时任务序列未变，不必重新计算
+        default_random_engine rng; // 个体独立的随机数序列，并行更新时结果与线程数无关
 
         double calcFitness();
+        void assign(const Wolf& other);
 
-        Wolf(int id, vector<Task> taskList) {
+        // order须已填入任务序列
+        Wolf(int id, TaskIndex* order, int n) {
             this->id = id;
-            this->taskList = taskList;
+            this->rng.seed(rand_eng());
+            this->order = order;
+            this->n = n;
             this->fitness = calcFitness(); // 自动计算适应度
         }
         Wolf() {
             this->id = -1;
+            this->order = nullptr;
+            this->n = 0;
             this->fitness = INT_MAX;
+            this->fingerprint = 0;
+            this->scored = 1; // 与fingerprint不同，即fitness尚未计算
         }
 };
 // 计算fitness（makespan）
 double Wolf::calcFitness() {
-    vector<double> t_ready, t_complete;
-    double sum_dataSize = 0.0; // 前i个任务的数据量和
-    for(auto i = taskList.begin(); i != taskList.end(); i++) {
-        sum_dataSize += (*i).dataSize; // 前i个任务的数据量和
-        t_ready.emplace_back(sum_dataSize / R(POWER)); // 第i个任务的准备时间
-        double t_dispose_i = (*i).cyclePerBit * (*i).dataSize / F; // 第i个任务的执行时间
-        // 第i个任务的完成时间
-        if(i == taskList.begin()) {
-            assert(t_complete.empty()); // i=1
-            t_complete.emplace_back( *(t_ready.rbegin()) + t_dispose_i ); // t_ready_i + t_dispose_i
-        }
-        else {
-            assert( ! t_complete.empty()); // i>1
-            double t_ready_i = *(t_ready.rbegin()), t_complete_i_1 = *(t_complete.rbegin());
-            t_complete.emplace_back(
-                (t_ready_i > t_complete_i_1 ? t_ready_i : t_complete_i_1) + t_dispose_i
-            ); // max{t_ready_i, t_complete_(i-1)} + t_dispose_i
-        }
-    }
-
-    assert(t_complete.size() == taskList.size());
-    return *(max_element(t_complete.begin(), t_complete.end()));
-}
-
-// Hamming Distance
-double calcHammingDistance(vector<Task> a, vector<Task> b) {
-    assert(a.size() == b.size());
-    double hd = 0;
-    for(int i=0; i<a.size(); i++) {
-        if(a.at(i).id != b.at(i).id)
-            hd++;
-    }
-    return hd;
-}
-
-// ？
-int Dn(int n) {
-    int d_n = - (n % 2) + (n + 1) % 2;
-    int sum = 0, u = n, d_u = d_n;
-    while(u > 0) {
-        sum += d_u;
-        d_u = - d_u * u;
-        u -= 1;
-    }
-    sum += d_u;
-    return sum;
+    fingerprint = hasher.hash(order, n);
+    scored = fingerprint;
+    return fitnessCache.fetch(fingerprint, [this]{ return evaluator.makespan(order, n); }); // 先查缓存
 }
-double Prob(int u) {
-    if(u > 10)
-        return 1.0 / u;
-    else
-        return (u - 1.0) * Dn(u - 2)/Dn(u);
+// 把另一个个体的任务序列和适应度复制到本个体的行，用于保存前三名和历史最佳
+void Wolf::assign(const Wolf& other) {
+    copy(other.order, other.order + n, order);
+    fitness = other.fitness;
+    fingerprint = other.fingerprint;
+    scored = other.scored;
 }
 
-// 根据距离更新任务序列
-vector<Task> getNewTaskSequence(vector<Task> taskSeq, int distance) {
-    auto newTaskSeq = taskSeq;
+// 根据距离更新任务序列，由taskSeq生成的新序列写入newTaskSeq，两者不能是同一行
+void getNewTaskSequence(const TaskIndex* taskSeq, int n, int distance, TaskIndex* newTaskSeq, default_random_engine& rng) {
+    copy(taskSeq, taskSeq + n, newTaskSeq);
 
-    // 保证距离范围
-    if(distance > taskSeq.size())
-        distance = taskSeq.size();
+    // 保证距离范围，负距离与原先按size()的无符号比较一致，取为n
+    if(distance < 0 || distance > n)
+        distance = n;
     if(distance < 1)
         distance = 1;
 
-    vector<int> indexes, pickedIndex, marked;
-    decltype(taskSeq) que;
-    for(int i=0; i<taskSeq.size(); i++)
-        indexes.emplace_back(i);
-    
-    for(int i=0; i<distance; i++) {
-        int rIndex = taskSeq.size() - i - 1; // 反向遍历下标
-        uniform_int_distribution<int> rand_int(0, rIndex);
-        int swapIndex = rand_int(rand_eng); // 随机取一个用来交换
-        swap(indexes.at(rIndex), indexes.at(swapIndex));
-        pickedIndex.emplace_back(indexes.at(rIndex)); // 记录已选的下标
-        que.emplace_back(taskSeq.at(indexes.at(rIndex)));
-        marked.emplace_back(0);
-    }
-
-    // ？
-    for(int i = 0; i < distance - 1; i++) {
-        int rIndex = distance - i - 1; // 反向遍历下标
-        uniform_int_distribution<int> rand_int(0, rIndex);
-        int swapIndex = rand_int(rand_eng);
-        if(marked.at(rIndex) == 1)
-            continue;
-        while(true) {
-            if(marked.at(swapIndex) == 0)
-                break;
-            int firstavailable = distance;
-            for(int i=0; i<distance; i++) {
-                if(marked.at(i) == 0)
-                    firstavailable = i;
-            }
-            if(firstavailable >= rIndex)
-                break;
-        }
-        swap(que.at(rIndex), que.at(swapIndex));
-
-        uniform_real_distribution<double> rand_p(0.0, 1.0);
-        double p = rand_p(rand_eng);
-        if(p < Prob(rIndex + 1))
-            marked.at(swapIndex) = 1;
-    }
-
-    for(int i=0; i<distance; i++)
-        newTaskSeq.at(pickedIndex.at(i)) = que.at(i);
-    return newTaskSeq;
+    perturbPositions(taskSeq, n, distance, newTaskSeq, rng);
 }
 
 // 读取Instance文件，格式：id - dataSize - cyclePerBit
@@ -188,20 +130,18 @@ vector<Task> readInstanceFile(string fileDir) {
     return taskList;
 }
 
-int main() {
+// 单次运行，返回记录行
+string runInstance(const SweepJob& job) {
+    rand_eng.seed(job.seed); // 每次运行使用独立的随机数序列
     string resultReport = "";
 
-// 实例测试
-vector<string> iTN {"10", "20", "30", "40", "50", "60", "70", "80", "90", "100"}; // 实例任务数量
-vector<string> iID {"0", "1", "2", "3", "4", "5", "6", "7", "8", "9"}; // 实例编号
-int iRepeatTimes = 5; // 每个实例重复次数
-
-for(auto it_n = iTN.begin(); it_n != iTN.end(); it_n++) { // 实例任务数量循环开始
-for(auto it_id = iID.begin(); it_id != iID.end(); it_id++) { // 实例编号循环开始
-for(int i_r = 0; i_r < iRepeatTimes; i_r++) { // 实例重复测试开始
-
     // 读取任务序列
-    vector<Task> taskList = readInstanceFile("./TestInstances/" + *it_n + "/" + *it_n + "_" + *it_id + ".txt");
+    vector<Task> taskList = readInstanceFile("./TestInstances/" + job.taskNum + "/" + job.taskNum + "_" + job.instanceId + ".txt");
+    evaluator.build(taskList, R(POWER), F); // 预计算传输时间和执行时间
+    hasher.build(taskList.size());
+    fitnessCache.clear();
+    localSearch.clear();
+    LowerBound lowerBound(evaluator); // 实例的下界，只计算一次，用于提前停止和计算差距
 
     // 记录历代最优值
     vector<double> championFitnessRecord;
@@ -209,52 +149,81 @@ for(int i_r = 0; i_r < iRepeatTimes; i_r++) { // 实例重复测试开始
     // 开始计时
     struct timeval startTime;
     mingw_gettimeofday(&startTime, NULL);
+    StopCondition stopCondition(TIME_BUDGET_MS, STAGNATION_EPOCHS, lowerBound.value); // 停止条件，达到下界即停止
 
-    // 初始化灰狼种群
+    // 初始化灰狼种群，任务序列存放在arena中，第POP_SIZE ~ POP_SIZE+3行存放前三名和历史最佳
+    int n = taskList.size();
+    PermutationArena arena;
+    arena.build(POP_SIZE + 4, n);
     vector<Wolf> population;
+    population.reserve(POP_SIZE);
     Wolf alphaWolf, betaWolf, deltaWolf, championWolf;
+    Wolf* copies[4] = {&alphaWolf, &betaWolf, &deltaWolf, &championWolf}; // 前三名和历史最佳的副本
+    for(int k=0; k<4; k++) {
+        (*copies[k]).order = arena.row(POP_SIZE + k);
+        (*copies[k]).n = n;
+    }
     championWolf.fitness = INT_MAX;
     for(int i=0; i<POP_SIZE; i++) {
         shuffle(taskList.begin(), taskList.end(), rand_eng); // 随机个体
-        population.emplace_back( Wolf(i, taskList) ); // 列入种群，自动计算适应度
+        TaskIndex* order = arena.row(i);
+        for(int j=0; j<n; j++)
+            order[j] = taskList[j].id;
+        population.emplace_back( Wolf(i, order, n) ); // 列入种群，自动计算适应度
     }
-    // 初始设置前三名和历史最佳
-    sort( population.begin(), population.end(), [](Wolf a, Wolf b){return a.fitness < b.fitness;} );
-    alphaWolf = population.at(0);
-    betaWolf = population.at(1);
-    deltaWolf = population.at(2);
+    // 初始设置前三名和历史最佳，按下标排名，个体本身不移动
+    vector<int> rank;
+    rankByFitness(population, rank);
+    alphaWolf.assign(population.at(rank.at(0)));
+    betaWolf.assign(population.at(rank.at(1)));
+    deltaWolf.assign(population.at(rank.at(2)));
     if(alphaWolf.fitness < championWolf.fitness)
-        championWolf = alphaWolf;
-
-    // 灰狼算法迭代
-    for(int epo = 0; epo < EPOCH; epo++) {
-        // 对于种群中的每一个个体
-        for(auto i = population.begin(); i != population.end(); i++) {
-            // 更新参数
-            double a = 2.0 * (1 - epo/EPOCH);
-            uniform_real_distribution<double> rand_real(0.0, 1.0);
-            double r_1 = rand_real(rand_eng);
-            double A = a * (2*r_1 - 1);
-
-            // 更新位置，Hamming Distance
-            uniform_int_distribution<int> rand_int(0, 2);
-            int wolfIndexChosen = rand_int(rand_eng);
-            double Dist = calcHammingDistance(population.at(wolfIndexChosen).taskList, (*i).taskList);
-            Dist *= A;            
-            (*i).taskList = getNewTaskSequence(population.at(wolfIndexChosen).taskList, (int)Dist);
-
-            // 更新fitness
-            (*i).fitness = (*i).calcFitness();
-        }
+        championWolf.assign(alphaWolf);
+
+    // 子任务可能被其他线程窃取执行，通过引用使用本次运行的状态
+    const MakespanEvaluator& runEvaluator = evaluator;
+    const PermutationHasher& runHasher = hasher;
+    FitnessCache& runCache = fitnessCache;
+    const Wolf* leaders[3] = {&alphaWolf, &betaWolf, &deltaWolf}; // 上一代的前三名，并行更新期间只读
+
+    // 灰狼算法迭代，初始解已达到下界时不迭代
+    int epochs = stopCondition.solvedAtStart(championWolf.fitness) ? 0 : EPOCH;
+    for(int epo = 0; epo < epochs; epo++) {
+        // 并行更新每一个个体，只读取上一代的前三名
+        scheduler().parallelFor(population.size(), [&](int begin, int end) {
+            for(auto i = population.begin() + begin; i != population.begin() + end; i++) {
+                // 更新参数
+                double a = 2.0 * (1 - epo/EPOCH);
+                uniform_real_distribution<double> rand_real(0.0, 1.0);
+                double r_1 = rand_real((*i).rng);
+                double A = a * (2*r_1 - 1);
+
+                // 更新位置，Hamming Distance
+                uniform_int_distribution<int> rand_int(0, 2);
+                int wolfIndexChosen = rand_int((*i).rng);
+                double Dist = hammingDistance((*leaders[wolfIndexChosen]).order, (*i).order, n);
+                Dist *= A;            
+                getNewTaskSequence((*leaders[wolfIndexChosen]).order, n, (int)Dist, (*i).order, (*i).rng);
+                (*i).fingerprint = runHasher.hash((*i).order, n);
+            }
+
+            // 批量更新本块的fitness，跳过任务序列未变的个体，只计算缓存未命中的个体
+            evaluatePopulation(runEvaluator, runCache, population.data() + begin, end - begin);
+        });
 
         // 更新前三名和历史最佳
-        sort( population.begin(), population.end(), [](Wolf a, Wolf b){return a.fitness < b.fitness;} );
-        alphaWolf = population.at(0);
-        betaWolf = population.at(1);
-        deltaWolf = population.at(2);
+        rankByFitness(population, rank);
+        polishElites(localSearch, evaluator, population, rank); // 精英个体局部搜索
+        alphaWolf.assign(population.at(rank.at(0)));
+        betaWolf.assign(population.at(rank.at(1)));
+        deltaWolf.assign(population.at(rank.at(2)));
         if(alphaWolf.fitness < championWolf.fitness)
-            championWolf = alphaWolf;
+            championWolf.assign(alphaWolf);
         championFitnessRecord.emplace_back(championWolf.fitness);
+
+        // 检查停止条件
+        if(stopCondition.shouldStop(epo + 1, championFitnessRecord))
+            break;
     }
 
     // 停止计时
@@ -263,24 +232,38 @@ for(int i_r = 0; i_r < iRepeatTimes; i_r++) { // 实例重复测试开始
     // 计算运行时间
     double duration = (endTime.tv_sec - startTime.tv_sec)*1000.0 + (endTime.tv_usec - startTime.tv_usec)/1000.0;
 
+    // 最终种群的多样性，不计入运行时间
+    vector<int> distanceMatrix;
+    hammingDistanceMatrix(population, distanceMatrix);
+    double diversity = populationDiversity(distanceMatrix, population.size(), n);
+
     // 记录信息
-    resultReport += *it_n + "\t"; // 任务数量
-    resultReport += *it_id + '\t'; // 测试实例编号
-    resultReport += to_string(i_r) + "\t"; // 重复测试次数
+    resultReport += job.taskNum + "\t"; // 任务数量
+    resultReport += job.instanceId + '\t'; // 测试实例编号
+    resultReport += to_string(job.repeat) + "\t"; // 重复测试次数
     resultReport += to_string(championWolf.fitness) + "\t"; // 最优makespan
     resultReport += to_string(duration) + "\t"; // 运行时间
+    resultReport += to_string(fitnessCache.hits.load()) + "\t"; // 适应度缓存命中次数
+    resultReport += to_string(fitnessCache.misses.load()) + "\t"; // 适应度缓存未命中次数
+    resultReport += to_string(fitnessCache.skipped.load()) + "\t"; // 任务序列未变而跳过的计算次数
+    resultReport += to_string(lowerBound.value) + "\t"; // makespan的下界
+    resultReport += to_string(championWolf.fitness / lowerBound.value - 1.0) + "\t"; // 与下界的相对差距
+    resultReport += string(stopCondition.reasonName()) + "\t"; // 停止原因
+    resultReport += to_string(stopCondition.stopEpoch) + "\t"; // 停止时的代数
+    resultReport += to_string(localSearch.moves) + "\t"; // 局部搜索接受的移动数
+    resultReport += to_string(diversity) + "\t"; // 最终种群两两Hamming距离的平均值 / 任务数
     resultReport += "\n";
+    return resultReport;
+}
 
-    // 控制台输出日志
-    time_t time_t_now = time(nullptr);
-    char* timeStamp = ctime(&time_t_now);
-    timeStamp[strlen(timeStamp) - 1] = 0;
-    cout << "[" << timeStamp <<"] ";
-    cout << "Completed Instance " + *it_n + "_" + *it_id + "_" + to_string(i_r) + ".\n";
+int main() {
+// 实例测试
+vector<string> iTN {"10", "20", "30", "40", "50", "60", "70", "80", "90", "100"}; // 实例任务数量
+vector<string> iID {"0", "1", "2", "3", "4", "5", "6", "7", "8", "9"}; // 实例编号
+int iRepeatTimes = 5; // 每个实例重复次数
 
-} // 实例重复测试结束
-} // 实例编号循环结束
-} // 实例任务数量循环结束
+    // 并行运行全部实例，按原顺序汇总
+    string resultReport = runSweep(iTN, iID, iRepeatTimes, time(0), runInstance);
 
     // 写入输出文件
     ofstream fileOut;
@@ -0,0 +1,101 @@
+#ifndef HAMMING_H
+#define HAMMING_H
+
+#include <assert.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+#if defined(__AVX2__) || defined(__AVX512BW__)
+#include <immintrin.h>
+#endif
+
+// 两个任务id序列的Hamming距离，即任务不同的位置数
+// 16位、32位任务下标按SIMD整段比较（AVX2每条指令16 / 8个，AVX-512BW每条指令32 / 16个），编译时加-mavx2或-mavx512bw启用
+template<class IndexT>
+int hammingDistance(const IndexT* a, const IndexT* b, int n) {
+    int hd = 0;
+    for(int i=0; i<n; i++) {
+        if(a[i] != b[i])
+            hd++;
+    }
+    return hd;
+}
+
+inline int hammingDistance(const uint16_t* a, const uint16_t* b, int n) {
+    int hd = 0, i = 0;
+#if defined(__AVX512BW__)
+    for(; i + 32 <= n; i += 32) {
+        __m512i x = _mm512_loadu_si512(a + i), y = _mm512_loadu_si512(b + i);
+        hd += __builtin_popcount(_mm512_cmpneq_epu16_mask(x, y));
+    }
+#endif
+#if defined(__AVX2__)
+    for(; i + 16 <= n; i += 16) {
+        __m256i x = _mm256_loadu_si256((const __m256i*)(a + i)), y = _mm256_loadu_si256((const __m256i*)(b + i));
+        unsigned equal = _mm256_movemask_epi8(_mm256_cmpeq_epi16(x, y)); // 每个相等的id占2位
+        hd += 16 - __builtin_popcount(equal) / 2;
+    }
+#endif
+    for(; i<n; i++) {
+        if(a[i] != b[i])
+            hd++;
+    }
+    return hd;
+}
+
+inline int hammingDistance(const uint32_t* a, const uint32_t* b, int n) {
+    int hd = 0, i = 0;
+#if defined(__AVX512BW__)
+    for(; i + 16 <= n; i += 16) {
+        __m512i x = _mm512_loadu_si512(a + i), y = _mm512_loadu_si512(b + i);
+        hd += __builtin_popcount(_mm512_cmpneq_epu32_mask(x, y));
+    }
+#endif
+#if defined(__AVX2__)
+    for(; i + 8 <= n; i += 8) {
+        __m256i x = _mm256_loadu_si256((const __m256i*)(a + i)), y = _mm256_loadu_si256((const __m256i*)(b + i));
+        unsigned equal = _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(x, y)));
+        hd += 8 - __builtin_popcount(equal);
+    }
+#endif
+    for(; i<n; i++) {
+        if(a[i] != b[i])
+            hd++;
+    }
+    return hd;
+}
+
+// 种群两两之间的Hamming距离，个体需有order和n成员，结果写入count行count列的对称矩阵（按行存放）
+// 按块遍历个体对，块内的行留在缓存中，整体O(P² · n / 每条指令比较的id数)
+template<class IndividualT>
+void hammingDistanceMatrix(const std::vector<IndividualT>& population, std::vector<int>& matrix) {
+    const int BLOCK = 16;
+    int count = population.size();
+    matrix.assign((size_t)count * count, 0);
+    for(int bi = 0; bi < count; bi += BLOCK) {
+        for(int bj = bi; bj < count; bj += BLOCK) {
+            for(int i = bi; i < bi + BLOCK && i < count; i++) {
+                for(int j = (bj > i + 1 ? bj : i + 1); j < bj + BLOCK && j < count; j++) {
+                    assert(population[i].n == population[j].n);
+                    int hd = hammingDistance(population[i].order, population[j].order, population[i].n);
+                    matrix[(size_t)i * count + j] = hd;
+                    matrix[(size_t)j * count + i] = hd;
+                }
+            }
+        }
+    }
+}
+
+// 种群多样性：两两Hamming距离的平均值除以任务数，0表示全部相同，随机排列时接近1
+inline double populationDiversity(const std::vector<int>& matrix, int count, int n) {
+    if(count < 2 || n == 0)
+        return 0.0;
+    long long sum = 0;
+    for(int i=0; i<count; i++) {
+        for(int j = i + 1; j < count; j++)
+            sum += matrix[(size_t)i * count + j];
+    }
+    return (double)sum / ((long long)count * (count - 1) / 2) / n;
+}
+
+#endif
@@ -0,0 +1,117 @@
+#include <iostream>
+#include <fstream>
+#include <assert.h>
+#include <vector>
+#include <string.h>
+#include <algorithm>
+#include <math.h>
+#include <time.h>
+#include "Makespan.h"
+#include "Johnson.h"
+#include "SweepRunner.h"
+using namespace std;
+
+#define W 5000000.0 // 信道带宽（Hz）
+#define G0 -40 // 路径损耗常数（dB）
+#define THETA 4 // 路径损耗指数
+#define D0 1 // 参考距离（m）
+#define D 100 // 传输距离（m）
+#define N0 -174 // 噪声功率谱密度（dB * m / Hz）
+#define F 1.0E9 // 服务器CPU频率（Hz）
+
+#define POWER 5.0 // 发射功率（mW）
+
+// 单次运行的状态，各线程独立
+thread_local MakespanEvaluator evaluator; // 当前实例的makespan评估器
+
+// 由发射功率计算任务传输速率
+double R(double power) {
+    return W * log(1 + 1.0E-12 * power / 3.981071705534985E-18 / W) / 0.6931471805599453;
+}
+
+class Task {
+    public:
+        int id;
+        double dataSize, cyclePerBit;
+
+        Task(int id, double dataSize, double cyclePerBit) {
+            this->id = id;
+            this->dataSize = dataSize;
+            this->cyclePerBit = cyclePerBit;
+        }
+};
+
+// 计算makespan
+double calcFitness(const vector<Task>& taskList) {
+    return evaluator.makespan(taskList);
+}
+
+// 读取Instance文件，格式：id - dataSize - cyclePerBit
+vector<Task> readInstanceFile(string fileDir) {
+    vector<Task> taskList;
+    ifstream fileIn;
+    fileIn.open(fileDir);
+    assert(fileIn); // 已打开
+
+    int lineNum; fileIn >> lineNum;
+    for(int i=0; i<lineNum; i++) {
+        int id_t; double data_t, cycle_t;
+        fileIn >> id_t >> data_t >> cycle_t;
+        taskList.emplace_back( Task(id_t, data_t, cycle_t) );
+    }
+
+    fileIn.close();
+    return taskList;
+}
+
+// 单次运行，返回记录行
+string runInstance(const SweepJob& job) {
+    string resultReport = "";
+
+    // 读取任务序列
+    vector<Task> taskList = readInstanceFile("./TestInstances/" + job.taskNum + "/" + job.taskNum + "_" + job.instanceId + ".txt");
+    evaluator.build(taskList, R(POWER), F); // 预计算传输时间和执行时间
+
+    // 开始计时
+    struct timeval startTime;
+    mingw_gettimeofday(&startTime, NULL);
+
+    // 按Johnson规则排序，得到最优序列
+    johnsonSort(evaluator, taskList);
+
+    // 计算makespan
+    double makespan = calcFitness(taskList);
+
+    // 停止计时
+    struct timeval endTime;
+    mingw_gettimeofday(&endTime, NULL);
+    // 计算运行时间
+    double duration = (endTime.tv_sec - startTime.tv_sec)*1000.0 + (endTime.tv_usec - startTime.tv_usec)/1000.0;
+
+    // 记录信息
+    resultReport += job.taskNum + "\t"; // 任务数量
+    resultReport += job.instanceId + '\t'; // 测试实例编号
+    resultReport += to_string(job.repeat) + "\t"; // 重复测试次数
+    resultReport += to_string(makespan) + "\t"; // 最优makespan
+    resultReport += to_string(duration) + "\t"; // 运行时间
+    resultReport += "\n";
+    return resultReport;
+}
+
+int main() {
+// 实例测试
+vector<string> iTN {"10", "20", "30", "40", "50", "60", "70", "80", "90", "100"}; // 实例任务数量
+vector<string> iID {"0", "1", "2", "3", "4", "5", "6", "7", "8", "9"}; // 实例编号
+int iRepeatTimes = 5; // 每个实例重复次数
+
+    // 并行运行全部实例，按原顺序汇总
+    string resultReport = runSweep(iTN, iID, iRepeatTimes, time(0), runInstance);
+
+    // 写入输出文件
+    ofstream fileOut;
+    fileOut.open("./Test Result - Johnson Rule.txt");
+    fileOut << resultReport;
+    fileOut.close();
+
+    return 0;
+}
\ No newline at end of file
@@ -0,0 +1,40 @@
+#ifndef JOHNSON_H
+#define JOHNSON_H
+
+#include <algorithm>
+#include <vector>
+#include "Makespan.h"
+
+// Johnson规则
+// 传输（信道）与执行（服务器CPU）构成两机流水车间，Johnson规则在O(n log n)内给出最优序列：
+// 传输时间不大于执行时间的任务按传输时间升序排在前，其余任务按执行时间降序排在后
+
+// 按Johnson规则就地排序任务序列
+template<class TaskT>
+void johnsonSort(const MakespanEvaluator& evaluator, std::vector<TaskT>& taskList) {
+    const std::vector<double>& a = evaluator.t_trans;
+    const std::vector<double>& b = evaluator.t_dispose;
+    auto front = std::stable_partition(taskList.begin(), taskList.end(),
+        [&](const TaskT& t){ return a[t.id] <= b[t.id]; }
+    );
+    std::stable_sort(taskList.begin(), front,
+        [&](const TaskT& x, const TaskT& y){ return a[x.id] < a[y.id]; }
+    );
+    std::stable_sort(front, taskList.end(),
+        [&](const TaskT& x, const TaskT& y){ return b[x.id] > b[y.id]; }
+    );
+}
+
+// 当前实例的最优makespan
+inline double johnsonMakespan(const MakespanEvaluator& evaluator) {
+    struct Id {
+        int id;
+    };
+    std::vector<Id> order(evaluator.size());
+    for(int i=0; i<order.size(); i++)
+        order[i].id = i;
+    johnsonSort(evaluator, order);
+    return evaluator.makespan(order);
+}
+
+#endif
@@ -0,0 +1,220 @@
+#ifndef LOCAL_SEARCH_H
+#define LOCAL_SEARCH_H
+
+#include <assert.h>
+#include <math.h>
+#include <algorithm>
+#include <utility>
+#include <vector>
+#include "Makespan.h"
+#include "MakespanTree.h"
+#include "Population.h"
+
+#ifndef LOCAL_SEARCH
+#define LOCAL_SEARCH 0 // 每代对精英个体做局部搜索的邻域，LocalSearchNeighborhood的按位或，0表示不做
+#endif
+#ifndef LOCAL_SEARCH_STRATEGY
+#define LOCAL_SEARCH_STRATEGY 0 // 0：首次改进，1：最好改进
+#endif
+#ifndef LOCAL_SEARCH_ELITES
+#define LOCAL_SEARCH_ELITES 1 // 每代做局部搜索的精英个数
+#endif
+#ifndef LOCAL_SEARCH_MAX_MOVES
+#define LOCAL_SEARCH_MAX_MOVES 0 // 每次局部搜索最多接受的移动数，0表示直到局部最优
+#endif
+
+enum LocalSearchNeighborhood {
+    NEIGHBORHOOD_ADJACENT = 1, // 交换相邻的两个任务
+    NEIGHBORHOOD_SWAP = 2, // 交换任意两个任务
+    NEIGHBORHOOD_INSERT = 4 // 把一个任务移到另一个位置
+};
+
+enum LocalSearchStrategy {
+    FIRST_IMPROVEMENT,
+    BEST_IMPROVEMENT
+};
+
+// 任务序列的局部搜索
+// 每次接受移动后O(n)预计算各前缀处的(t_ready, t_complete)和各后缀的摘要（MakespanSegment）
+// 移动只改变位置[l, r]，其中除两端以外的任务保持相对顺序；扫描时逐个位置扩展这一段的摘要，每个邻居O(1)评估
+// 完整扫描一遍邻域为O(n^2)，不调用makespan()
+class LocalSearch {
+    public:
+        long long moves; // 接受的移动数
+        long long evaluations; // 评估的邻居数
+
+        LocalSearch() {
+            this->moves = 0;
+            this->evaluations = 0;
+        }
+
+        // 每次运行前调用
+        void clear() {
+            moves = 0;
+            evaluations = 0;
+        }
+
+        // 预留n个任务所需的空间，之后improve()不再分配内存
+        void reserve(int n) {
+            ready.reserve(n + 1);
+            complete.reserve(n + 1);
+            suffix.reserve(n + 1);
+        }
+
+        // 对order做局部搜索，直到局部最优或已接受maxMoves个移动（0表示不限），order原地更新，返回其makespan
+        template<class IndexT>
+        double improve(const MakespanEvaluator& evaluator, IndexT* order, int n, int neighborhoods = LOCAL_SEARCH,
+                       LocalSearchStrategy strategy = (LocalSearchStrategy)LOCAL_SEARCH_STRATEGY, int maxMoves = LOCAL_SEARCH_MAX_MOVES) {
+            this->evaluator = &evaluator;
+            prepare(order, n);
+            double current = complete[n];
+            for(int accepted = 0; maxMoves <= 0 || accepted < maxMoves; accepted++) {
+                Move best = Move{MOVE_NONE, 0, 0, current * (1.0 - 1.0E-12)}; // 容许浮点误差，避免在等值的序列间循环
+                bool first = strategy == FIRST_IMPROVEMENT;
+                bool adjacent = neighborhoods & NEIGHBORHOOD_ADJACENT;
+                if(adjacent)
+                    scanSwaps(order, n, 1, 1, first, best);
+                if((neighborhoods & NEIGHBORHOOD_SWAP) && ! (first && best.type != MOVE_NONE))
+                    scanSwaps(order, n, adjacent ? 2 : 1, n, first, best); // 已扫描的相邻交换不重复
+                if((neighborhoods & NEIGHBORHOOD_INSERT) && ! (first && best.type != MOVE_NONE))
+                    scanInsertions(order, n, first, best);
+                if(best.type == MOVE_NONE)
+                    break;
+                apply(order, best);
+                moves++;
+                prepare(order, n);
+                assert(fabs(complete[n] - best.makespan) <= 1.0E-9 * best.makespan);
+                current = complete[n];
+            }
+            return current;
+        }
+
+    private:
+        enum MoveType {
+            MOVE_NONE,
+            MOVE_SWAP, // 交换位置i、j
+            MOVE_INSERT // 把位置i上的任务移到位置j
+        };
+        struct Move {
+            MoveType type;
+            int i, j;
+            double makespan;
+        };
+
+        const MakespanEvaluator* evaluator;
+        std::vector<double> ready, complete; // 前i个任务处理完后的t_ready和t_complete，i = 0 ~ n
+        std::vector<MakespanSegment> suffix; // 位置i ~ n-1的摘要，suffix[n]为空段
+
+        template<class IndexT>
+        void prepare(const IndexT* order, int n) {
+            ready.resize(n + 1);
+            complete.resize(n + 1);
+            suffix.resize(n + 1);
+            ready[0] = complete[0] = 0.0;
+            for(int i=0; i<n; i++) {
+                ready[i + 1] = ready[i];
+                complete[i + 1] = complete[i];
+                leaf(order[i]).advance(ready[i + 1], complete[i + 1]);
+            }
+            suffix[n] = MakespanSegment::empty();
+            for(int i = n - 1; i >= 0; i--)
+                suffix[i] = MakespanSegment::combine(leaf(order[i]), suffix[i + 1]);
+        }
+
+        MakespanSegment leaf(int id) const {
+            return MakespanSegment::leaf(*evaluator, id);
+        }
+
+        // 从前p个任务处理完后的状态开始，依次处理段a、b、c
+        double chain(int p, const MakespanSegment& a, const MakespanSegment& b, const MakespanSegment& c) const {
+            double t_ready = ready[p], t_complete = complete[p];
+            a.advance(t_ready, t_complete);
+            b.advance(t_ready, t_complete);
+            c.advance(t_ready, t_complete);
+            return t_complete;
+        }
+        double chain(int p, const MakespanSegment& a, const MakespanSegment& b, const MakespanSegment& c, const MakespanSegment& d) const {
+            double t_ready = ready[p], t_complete = complete[p];
+            a.advance(t_ready, t_complete);
+            b.advance(t_ready, t_complete);
+            c.advance(t_ready, t_complete);
+            d.advance(t_ready, t_complete);
+            return t_complete;
+        }
+
+        // 记录优于best的移动，首次改进时返回true表示停止扫描
+        bool offer(MoveType type, int i, int j, double makespan, bool first, Move& best) {
+            evaluations++;
+            if(makespan >= best.makespan)
+                return false;
+            best = Move{type, i, j, makespan};
+            return first;
+        }
+
+        // 交换位置i < j，minGap <= j - i <= maxGap：前i个任务、order[j]、位置i+1 ~ j-1、order[i]、位置j+1 ~ n-1
+        template<class IndexT>
+        void scanSwaps(const IndexT* order, int n, int minGap, int maxGap, bool first, Move& best) {
+            for(int i=0; i + 1 < n; i++) {
+                MakespanSegment middle = MakespanSegment::empty(), atI = leaf(order[i]);
+                for(int j = i + 1; j < n && j - i <= maxGap; j++) {
+                    MakespanSegment atJ = leaf(order[j]);
+                    if(j - i >= minGap && offer(MOVE_SWAP, i, j, chain(i, atJ, middle, atI, suffix[j + 1]), first, best))
+                        return;
+                    middle = MakespanSegment::combine(middle, atJ);
+                }
+            }
+        }
+
+        // 向后插入i -> j > i：前i个任务、位置i+1 ~ j、order[i]、位置j+1 ~ n-1
+        // 向前插入i -> j < i：前j个任务、order[i]、位置j ~ i-1、位置i+1 ~ n-1；j = i - 1与i - 1 -> i相同，不重复扫描
+        template<class IndexT>
+        void scanInsertions(const IndexT* order, int n, bool first, Move& best) {
+            for(int i=0; i<n; i++) {
+                MakespanSegment moved = leaf(order[i]), middle = MakespanSegment::empty();
+                for(int j = i + 1; j < n; j++) {
+                    middle = MakespanSegment::combine(middle, leaf(order[j]));
+                    if(offer(MOVE_INSERT, i, j, chain(i, middle, moved, suffix[j + 1]), first, best))
+                        return;
+                }
+                middle = MakespanSegment::empty();
+                for(int j = i - 1; j >= 0; j--) {
+                    middle = MakespanSegment::combine(leaf(order[j]), middle);
+                    if(j < i - 1 && offer(MOVE_INSERT, i, j, chain(j, moved, middle, suffix[i + 1]), first, best))
+                        return;
+                }
+            }
+        }
+
+        template<class IndexT>
+        static void apply(IndexT* order, const Move& move) {
+            int i = move.i, j = move.j;
+            if(move.type == MOVE_SWAP)
+                std::swap(order[i], order[j]);
+            else if(j > i)
+                std::rotate(order + i, order + i + 1, order + j + 1);
+            else
+                std::rotate(order + j, order + i, order + i + 1);
+        }
+};
+
+// 对按rank排名的前LOCAL_SEARCH_ELITES个个体做局部搜索，原地更新任务序列
+// 个体需有order、n和calcFitness()，有改进的个体由calcFitness()重新计算指纹和适应度，之后重新排名
+template<class IndividualT>
+void polishElites(LocalSearch& search, const MakespanEvaluator& evaluator, std::vector<IndividualT>& population, std::vector<int>& rank) {
+    if(! LOCAL_SEARCH)
+        return;
+    bool improved = false;
+    for(int k=0; k<LOCAL_SEARCH_ELITES && k<rank.size(); k++) {
+        IndividualT& c = population[rank[k]];
+        long long moves = search.moves;
+        search.improve(evaluator, c.order, c.n);
+        if(search.moves != moves) {
+            c.fitness = c.calcFitness();
+            improved = true;
+        }
+    }
+    if(improved)
+        rankByFitness(population, rank);
+}
+
+#endif
@@ -0,0 +1,42 @@
+#ifndef LOWER_BOUND_H
+#define LOWER_BOUND_H
+
+#include <vector>
+#include "Makespan.h"
+#include "Johnson.h"
+
+// makespan的下界，每个实例只计算一次
+// 信道：全部任务传输完之后，最后一个任务至少还需执行，Σ传输时间 + min执行时间
+// 服务器：第一个任务传输完之前服务器空闲，min传输时间 + Σ执行时间
+// 单服务器模型是两机流水车间，Johnson规则给出的最优值不小于以上两项，且可以达到
+// 多服务器模型的下界由BranchAndBound.h按节点计算
+class LowerBound {
+    public:
+        double channel; // Σ传输时间 + min执行时间
+        double server; // min传输时间 + Σ执行时间
+        double johnson; // Johnson规则的最优makespan
+        double value; // 以上各项的最大值
+
+        explicit LowerBound(const MakespanEvaluator& evaluator) {
+            double sumTrans = 0.0, sumDispose = 0.0, minTrans = 0.0, minDispose = 0.0;
+            for(int id=0; id<evaluator.size(); id++) {
+                double a = evaluator.t_trans[id], b = evaluator.t_dispose[id];
+                sumTrans += a;
+                sumDispose += b;
+                if(id == 0 || a < minTrans)
+                    minTrans = a;
+                if(id == 0 || b < minDispose)
+                    minDispose = b;
+            }
+            channel = sumTrans + minDispose;
+            server = minTrans + sumDispose;
+            johnson = johnsonMakespan(evaluator);
+            value = channel;
+            if(server > value)
+                value = server;
+            if(johnson > value)
+                value = johnson;
+        }
+};
+
+#endif
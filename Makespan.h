@@ -0,0 +1,215 @@
+#ifndef MAKESPAN_H
+#define MAKESPAN_H
+
+#include <assert.h>
+#include <vector>
+#if defined(__AVX2__) || defined(__AVX512F__)
+#include <immintrin.h>
+#endif
+
+// makespan评估器
+// 每个实例只预计算一次各任务的传输时间和执行时间，之后按任务序列单次遍历求makespan，不分配堆内存
+class MakespanEvaluator {
+    public:
+        std::vector<double> t_trans; // 传输时间 dataSize / R，按任务id存放
+        std::vector<double> t_dispose; // 执行时间 cyclePerBit * dataSize / F，按任务id存放
+        double totalDispose; // 全部任务的执行时间之和，供带截断的计算使用
+
+        // 由实例任务列表预计算，任务id须为0 ~ n-1
+        template<class TaskT>
+        void build(const std::vector<TaskT>& taskList, double rate, double freq) {
+            int n = taskList.size();
+            t_trans.assign(n, 0.0);
+            t_dispose.assign(n, 0.0);
+            for(auto i = taskList.begin(); i != taskList.end(); i++) {
+                assert((*i).id >= 0 && (*i).id < n);
+                t_trans.at((*i).id) = (*i).dataSize / rate;
+                t_dispose.at((*i).id) = (*i).cyclePerBit * (*i).dataSize / freq;
+            }
+            totalDispose = 0.0;
+            for(int id=0; id<n; id++)
+                totalDispose += t_dispose[id];
+        }
+
+        int size() const {
+            return t_trans.size();
+        }
+
+        // 计算任务id序列的makespan
+        template<class IndexT>
+        double makespan(const IndexT* order, int n) const {
+            const double* trans = t_trans.data();
+            const double* dispose = t_dispose.data();
+            double t_ready = 0.0, t_complete = 0.0;
+            for(int i=0; i<n; i++) {
+                t_ready += trans[order[i]]; // 第i个任务的准备时间
+                // max{t_ready_i, t_complete_(i-1)} + t_dispose_i，完成时间单调不减，最后一个即为最大值
+                t_complete = (t_ready > t_complete ? t_ready : t_complete) + dispose[order[i]];
+            }
+            return t_complete;
+        }
+
+        // 带截断的makespan：处理完前i个任务后，t_complete + 其余任务的执行时间之和 不大于最终的makespan
+        // 该下界超过cutoff时提前返回false，result为该下界，序列不可能优于cutoff；否则返回true，result为准确的makespan
+        // 其余任务的执行时间之和由totalDispose逐个减去，无需按序列预计算
+        template<class IndexT>
+        bool makespanWithin(const IndexT* order, int n, double cutoff, double& result) const {
+            const double* trans = t_trans.data();
+            const double* dispose = t_dispose.data();
+            double limit = cutoff * (1.0 + 1.0E-12); // 容许逐个相减的浮点误差
+            double t_ready = 0.0, t_complete = 0.0, rest = totalDispose;
+            for(int i=0; i<n; i++) {
+                t_ready += trans[order[i]];
+                t_complete = (t_ready > t_complete ? t_ready : t_complete) + dispose[order[i]];
+                rest -= dispose[order[i]];
+                if(t_complete + rest > limit) {
+                    result = t_complete + rest;
+                    return false;
+                }
+            }
+            result = t_complete;
+            return true;
+        }
+
+        // 计算任务序列的makespan
+        template<class TaskT>
+        double makespan(const std::vector<TaskT>& taskList) const {
+            assert(taskList.size() == t_trans.size());
+            const double* trans = t_trans.data();
+            const double* dispose = t_dispose.data();
+            double t_ready = 0.0, t_complete = 0.0;
+            for(auto i = taskList.begin(); i != taskList.end(); i++) {
+                t_ready += trans[(*i).id];
+                t_complete = (t_ready > t_complete ? t_ready : t_complete) + dispose[(*i).id];
+            }
+            return t_complete;
+        }
+
+        // 批量计算makespan，orders为count行n列的任务id矩阵（按行存放），结果写入result
+        // 每个SIMD通道计算一个个体，编译时加-mavx2或-mavx512f启用，否则逐个计算
+        // IndexT为任务下标类型，窄于32位时按通道逐个载入并零扩展，调用方不必先把矩阵加宽为int
+        template<class IndexT>
+        void makespanBatch(const IndexT* orders, int count, int n, double* result) const {
+            int k = 0;
+#if defined(__AVX512F__)
+            for(; k + 8 <= count; k += 8)
+                makespanLanes8(orders + k * n, n, result + k);
+#endif
+#if defined(__AVX2__)
+            for(; k + 4 <= count; k += 4)
+                makespanLanes4(orders + k * n, n, result + k);
+#endif
+            for(; k < count; k++)
+                result[k] = makespan(orders + k * n, n);
+        }
+
+        // 带截断的批量计算，逐行同makespanWithin：exact[k]为1时result[k]为准确的makespan，为0时只是超过cutoff的下界
+        // 下界t_complete + 其余任务的执行时间之和逐步不减，一组SIMD通道全部超过cutoff时整组提前停止；只有部分通道超过时算完整组，结果都是准确值
+        template<class IndexT>
+        void makespanBatchWithin(const IndexT* orders, int count, int n, double cutoff, double* result, char* exact) const {
+            int k = 0;
+#if defined(__AVX512F__)
+            for(; k + 8 <= count; k += 8)
+                makespanLanes8Within(orders + k * n, n, cutoff, result + k, exact + k);
+#endif
+#if defined(__AVX2__)
+            for(; k + 4 <= count; k += 4)
+                makespanLanes4Within(orders + k * n, n, cutoff, result + k, exact + k);
+#endif
+            for(; k < count; k++)
+                exact[k] = makespanWithin(orders + k * n, n, cutoff, result[k]);
+        }
+
+    private:
+#if defined(__AVX2__)
+        // 4行第i列的任务id：int矩阵按行偏移gather，较窄的下标类型逐个载入，避免gather越过矩阵末尾读取
+        static __m128i columnIds4(const int* rows, int n, int i) {
+            return _mm_i32gather_epi32(rows + i, _mm_setr_epi32(0, n, 2 * n, 3 * n), 4);
+        }
+        template<class IndexT>
+        static __m128i columnIds4(const IndexT* rows, int n, int i) {
+            return _mm_setr_epi32(rows[i], rows[n + i], rows[2 * n + i], rows[3 * n + i]);
+        }
+
+        // 4个个体同时计算，每步取4行同一列的任务id，再gather传输时间和执行时间
+        template<class IndexT>
+        void makespanLanes4(const IndexT* rows, int n, double* result) const {
+            __m256d t_ready = _mm256_setzero_pd(), t_complete = _mm256_setzero_pd();
+            for(int i=0; i<n; i++) {
+                __m128i ids = columnIds4(rows, n, i);
+                t_ready = _mm256_add_pd(t_ready, _mm256_i32gather_pd(t_trans.data(), ids, 8));
+                t_complete = _mm256_add_pd(_mm256_max_pd(t_ready, t_complete), _mm256_i32gather_pd(t_dispose.data(), ids, 8));
+            }
+            _mm256_storeu_pd(result, t_complete);
+        }
+        template<class IndexT>
+        void makespanLanes4Within(const IndexT* rows, int n, double cutoff, double* result, char* exact) const {
+            const __m256d limit = _mm256_set1_pd(cutoff * (1.0 + 1.0E-12));
+            __m256d t_ready = _mm256_setzero_pd(), t_complete = _mm256_setzero_pd(), rest = _mm256_set1_pd(totalDispose);
+            for(int i=0; i<n; i++) {
+                __m128i ids = columnIds4(rows, n, i);
+                __m256d dispose = _mm256_i32gather_pd(t_dispose.data(), ids, 8);
+                t_ready = _mm256_add_pd(t_ready, _mm256_i32gather_pd(t_trans.data(), ids, 8));
+                t_complete = _mm256_add_pd(_mm256_max_pd(t_ready, t_complete), dispose);
+                rest = _mm256_sub_pd(rest, dispose);
+                __m256d bound = _mm256_add_pd(t_complete, rest);
+                if(_mm256_movemask_pd(_mm256_cmp_pd(bound, limit, _CMP_GT_OQ)) == 0xF) {
+                    _mm256_storeu_pd(result, bound);
+                    for(int l=0; l<4; l++)
+                        exact[l] = 0;
+                    return;
+                }
+            }
+            _mm256_storeu_pd(result, t_complete);
+            for(int l=0; l<4; l++)
+                exact[l] = 1;
+        }
+#endif
+#if defined(__AVX512F__)
+        // 8行第i列的任务id，同columnIds4
+        static __m256i columnIds8(const int* rows, int n, int i) {
+            return _mm256_i32gather_epi32(rows + i, _mm256_mullo_epi32(_mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7), _mm256_set1_epi32(n)), 4);
+        }
+        template<class IndexT>
+        static __m256i columnIds8(const IndexT* rows, int n, int i) {
+            return _mm256_setr_epi32(rows[i], rows[n + i], rows[2 * n + i], rows[3 * n + i],
+                                     rows[4 * n + i], rows[5 * n + i], rows[6 * n + i], rows[7 * n + i]);
+        }
+
+        // 8个个体同时计算
+        template<class IndexT>
+        void makespanLanes8(const IndexT* rows, int n, double* result) const {
+            __m512d t_ready = _mm512_setzero_pd(), t_complete = _mm512_setzero_pd();
+            for(int i=0; i<n; i++) {
+                __m256i ids = columnIds8(rows, n, i);
+                t_ready = _mm512_add_pd(t_ready, _mm512_i32gather_pd(ids, t_trans.data(), 8));
+                t_complete = _mm512_add_pd(_mm512_max_pd(t_ready, t_complete), _mm512_i32gather_pd(ids, t_dispose.data(), 8));
+            }
+            _mm512_storeu_pd(result, t_complete);
+        }
+        template<class IndexT>
+        void makespanLanes8Within(const IndexT* rows, int n, double cutoff, double* result, char* exact) const {
+            const __m512d limit = _mm512_set1_pd(cutoff * (1.0 + 1.0E-12));
+            __m512d t_ready = _mm512_setzero_pd(), t_complete = _mm512_setzero_pd(), rest = _mm512_set1_pd(totalDispose);
+            for(int i=0; i<n; i++) {
+                __m256i ids = columnIds8(rows, n, i);
+                __m512d dispose = _mm512_i32gather_pd(ids, t_dispose.data(), 8);
+                t_ready = _mm512_add_pd(t_ready, _mm512_i32gather_pd(ids, t_trans.data(), 8));
+                t_complete = _mm512_add_pd(_mm512_max_pd(t_ready, t_complete), dispose);
+                rest = _mm512_sub_pd(rest, dispose);
+                __m512d bound = _mm512_add_pd(t_complete, rest);
+                if(_mm512_cmp_pd_mask(bound, limit, _CMP_GT_OQ) == 0xFF) {
+                    _mm512_storeu_pd(result, bound);
+                    for(int l=0; l<8; l++)
+                        exact[l] = 0;
+                    return;
+                }
+            }
+            _mm512_storeu_pd(result, t_complete);
+            for(int l=0; l<8; l++)
+                exact[l] = 1;
+        }
+#endif
+};
+
+#endif
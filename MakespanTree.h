@@ -0,0 +1,193 @@
+#ifndef MAKESPAN_TREE_H
+#define MAKESPAN_TREE_H
+
+#include <assert.h>
+#include <math.h>
+#include <utility>
+#include <vector>
+#include "Makespan.h"
+
+// 一段连续任务的摘要：
+//   trans   段内传输时间之和
+//   dispose 段内执行时间之和
+//   span    段内任务从段起点开始传输时的最晚完成时间
+// 段从传输起点S、前一任务完成时间C开始时，段末完成时间为 max(C + dispose, S + span)
+// 相邻两段可按顺序合并，空段为{0, 0, -HUGE_VAL}
+struct MakespanSegment {
+    double trans, dispose, span;
+
+    static MakespanSegment empty() {
+        return MakespanSegment{0.0, 0.0, -HUGE_VAL};
+    }
+
+    static MakespanSegment leaf(const MakespanEvaluator& evaluator, int id) {
+        double trans = evaluator.t_trans[id], dispose = evaluator.t_dispose[id];
+        return MakespanSegment{trans, dispose, trans + dispose};
+    }
+
+    static MakespanSegment combine(const MakespanSegment& a, const MakespanSegment& b) {
+        double spanA = a.span + b.dispose, spanB = a.trans + b.span;
+        return MakespanSegment{a.trans + b.trans, a.dispose + b.dispose, spanA > spanB ? spanA : spanB};
+    }
+
+    // 从传输起点ready、前一任务完成时间complete开始处理本段，更新两者为段末的状态
+    void advance(double& ready, double& complete) const {
+        double a = complete + dispose, b = ready + span;
+        complete = a > b ? a : b;
+        ready += trans;
+    }
+};
+
+// makespan线段树
+// 叶子对应任务序列中的位置，每个节点保存以该节点为根的一段连续任务的摘要
+// 相邻两段可合并，因此交换任务只需更新O(log n)个节点
+class MakespanTree {
+    public:
+        MakespanTree() {
+            this->evaluator = nullptr;
+            this->leafBase = 0;
+            this->stale = false;
+        }
+
+        // 由任务序列建树，O(n)
+        template<class TaskT>
+        void build(const MakespanEvaluator& evaluator, const std::vector<TaskT>& taskList) {
+            this->evaluator = &evaluator;
+            int n = taskList.size();
+            order.resize(n);
+            for(int i=0; i<n; i++)
+                order[i] = taskList[i].id;
+            rebuild();
+        }
+
+        // 由任务id序列建树，O(n)，重复建树时复用已有的空间
+        template<class IndexT>
+        void build(const MakespanEvaluator& evaluator, const IndexT* taskOrder, int n) {
+            this->evaluator = &evaluator;
+            order.assign(taskOrder, taskOrder + n);
+            rebuild();
+        }
+
+        // 清空，保留已分配的空间
+        void clear() {
+            order.clear();
+            pending.clear();
+            stale = false;
+        }
+
+        bool empty() const {
+            return order.empty();
+        }
+        int size() const {
+            return order.size();
+        }
+
+        // 位置i上的任务id
+        int taskAt(int i) const {
+            return order[i];
+        }
+
+        // 当前序列的makespan
+        double makespan() const {
+            assert(pending.empty() && ! stale);
+            return order.empty() ? 0.0 : node[1].span;
+        }
+
+        // 交换位置i、j上的任务并立即更新，O(log n)
+        void swap(int i, int j) {
+            if(i == j)
+                return;
+            std::swap(order.at(i), order.at(j));
+            node[leafBase + i] = leaf(order[i]);
+            node[leafBase + j] = leaf(order[j]);
+            update(leafBase + i);
+            update(leafBase + j);
+        }
+
+        // 交换位置i、j后的makespan，不提交交换
+        double peekSwap(int i, int j) {
+            swap(i, j);
+            double result = makespan();
+            swap(i, j);
+            return result;
+        }
+
+        // 只记录交换，待flush()时统一更新；适用于连续应用多个交换的场合
+        // 记录的位置超过叶子数时不再逐条记录，flush()时整体重建
+        void markSwap(int i, int j) {
+            if(i == j)
+                return;
+            std::swap(order.at(i), order.at(j));
+            node[leafBase + i] = leaf(order[i]);
+            node[leafBase + j] = leaf(order[j]);
+            if(stale)
+                return;
+            pending.emplace_back(i);
+            pending.emplace_back(j);
+            if(pending.size() > leafBase) {
+                stale = true;
+                pending.clear();
+            }
+        }
+
+        // 更新所有记录的交换，按O(k log n)和O(n)中较小者选择逐条更新或整体重建
+        void flush() {
+            if(pending.empty() && ! stale)
+                return;
+            int depth = 0;
+            while((1 << depth) < leafBase)
+                depth++;
+            if(! stale && pending.size() * depth < leafBase) {
+                for(auto i = pending.begin(); i != pending.end(); i++)
+                    update(leafBase + (*i));
+            }
+            else {
+                for(int p = leafBase - 1; p > 0; p--)
+                    node[p] = combine(node[2 * p], node[2 * p + 1]);
+            }
+            pending.clear();
+            stale = false;
+        }
+
+    private:
+        typedef MakespanSegment Segment;
+
+        const MakespanEvaluator* evaluator;
+        std::vector<int> order; // 各位置上的任务id
+        std::vector<Segment> node; // 1为根，leafBase + i为位置i的叶子
+        std::vector<int> pending; // 已交换但未更新的位置
+        bool stale; // 待更新的位置过多，需整体重建
+        int leafBase;
+
+        Segment leaf(int id) const {
+            return Segment::leaf(*evaluator, id);
+        }
+
+        static Segment combine(const Segment& a, const Segment& b) {
+            return Segment::combine(a, b);
+        }
+
+        // 由order重建全部节点
+        void rebuild() {
+            int n = order.size();
+            leafBase = 1;
+            while(leafBase < n)
+                leafBase <<= 1;
+            node.assign(2 * leafBase, Segment::empty()); // 空叶子不影响合并结果
+            for(int i=0; i<n; i++)
+                node[leafBase + i] = leaf(order[i]);
+            for(int p = leafBase - 1; p > 0; p--)
+                node[p] = combine(node[2 * p], node[2 * p + 1]);
+            pending.clear();
+            pending.reserve(leafBase + 2); // markSwap()记录的位置最多leafBase + 2个，之后不再分配内存
+            stale = false;
+        }
+
+        // 自叶子向上更新
+        void update(int p) {
+            for(p >>= 1; p > 0; p >>= 1)
+                node[p] = combine(node[2 * p], node[2 * p + 1]);
+        }
+};
+
+#endif
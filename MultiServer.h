@@ -0,0 +1,67 @@
+#ifndef MULTI_SERVER_H
+#define MULTI_SERVER_H
+
+#include <assert.h>
+#include <vector>
+
+// 多服务器模型的makespan评估器
+// 任务按序列依次通过同一信道传输，每个任务分配给一台服务器，各服务器按到达顺序执行分配给自己的任务
+// 服务器CPU频率各不相同，执行时间按任务和服务器预计算
+class MultiServerEvaluator {
+    public:
+        std::vector<double> t_trans; // 传输时间 dataSize / R，按任务id存放
+        std::vector<double> cycles; // 计算量 cyclePerBit * dataSize，按任务id存放
+        std::vector<double> frequency; // CPU频率，按服务器id存放
+        std::vector<double> t_dispose; // 执行时间，第m行为服务器m上各任务的执行时间
+
+        // 由实例任务列表和服务器列表预计算，任务id须为0 ~ n-1，服务器id须为0 ~ M-1
+        template<class TaskT, class ServerT>
+        void build(const std::vector<TaskT>& taskList, double rate, const std::vector<ServerT>& serverList) {
+            int n = taskList.size(), M = serverList.size();
+            t_trans.assign(n, 0.0);
+            cycles.assign(n, 0.0);
+            frequency.assign(M, 0.0);
+            for(auto i = taskList.begin(); i != taskList.end(); i++) {
+                assert((*i).id >= 0 && (*i).id < n);
+                t_trans.at((*i).id) = (*i).dataSize / rate;
+                cycles.at((*i).id) = (*i).cyclePerBit * (*i).dataSize;
+            }
+            for(auto s = serverList.begin(); s != serverList.end(); s++) {
+                assert((*s).id >= 0 && (*s).id < M);
+                frequency.at((*s).id) = (*s).frequency;
+            }
+            t_dispose.assign(M * n, 0.0);
+            for(int m=0; m<M; m++)
+                for(int id=0; id<n; id++)
+                    t_dispose[m * n + id] = cycles[id] / frequency[m];
+        }
+
+        int size() const {
+            return t_trans.size();
+        }
+
+        int serverNum() const {
+            return frequency.size();
+        }
+
+        double dispose(int id, int server) const {
+            return t_dispose[server * size() + id];
+        }
+
+        // 计算任务id序列的makespan，server[i]为第i个任务所分配的服务器
+        template<class IndexT>
+        double makespan(const IndexT* order, const int* server, int n) const {
+            std::vector<double> t_complete(serverNum(), 0.0);
+            double t_ready = 0.0, result = 0.0;
+            for(int i=0; i<n; i++) {
+                t_ready += t_trans[order[i]];
+                double& t = t_complete[server[i]];
+                t = (t_ready > t ? t_ready : t) + dispose(order[i], server[i]);
+                if(t > result)
+                    result = t;
+            }
+            return result;
+        }
+};
+
+#endif
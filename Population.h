@@ -0,0 +1,69 @@
+#ifndef POPULATION_H
+#define POPULATION_H
+
+#include <assert.h>
+#include <stdint.h>
+#include <algorithm>
+#include <limits>
+#include <numeric>
+#include <vector>
+
+#ifndef TASK_INDEX_T
+#define TASK_INDEX_T uint16_t // 任务下标类型，任务数超过65536时改为uint32_t
+#endif
+typedef TASK_INDEX_T TaskIndex;
+
+// 种群任务序列的连续存储，每行是一个个体的任务序列
+// 行中存放任务下标（即任务id），任务的数据由共享只读的MakespanEvaluator按下标查找
+// 每次运行开始时一次性分配，此后行指针保持有效，迭代过程中不再分配内存
+class PermutationArena {
+    public:
+        PermutationArena() {
+            this->rowNum = 0;
+            this->n = 0;
+        }
+
+        void build(int rows, int n) {
+            assert(n == 0 || n - 1 <= std::numeric_limits<TaskIndex>::max());
+            this->rowNum = rows;
+            this->n = n;
+            cells.assign((size_t)rows * n, 0);
+        }
+
+        int rows() const {
+            return rowNum;
+        }
+        int width() const {
+            return n;
+        }
+
+        TaskIndex* row(int r) {
+            assert(r >= 0 && r < rowNum);
+            return cells.data() + (size_t)r * n;
+        }
+        const TaskIndex* row(int r) const {
+            assert(r >= 0 && r < rowNum);
+            return cells.data() + (size_t)r * n;
+        }
+
+        void copyRow(int to, int from) {
+            std::copy(row(from), row(from) + n, row(to));
+        }
+
+    private:
+        std::vector<TaskIndex> cells; // rows行n列，按行存放
+        int rowNum, n;
+};
+
+// 按fitness升序排列个体下标，个体本身不移动
+// rank保留上次的顺序作为排序的输入，与每代整体排序个体时的比较序列一致
+template<class IndividualT>
+void rankByFitness(const std::vector<IndividualT>& population, std::vector<int>& rank) {
+    if(rank.size() != population.size()) {
+        rank.resize(population.size());
+        std::iota(rank.begin(), rank.end(), 0);
+    }
+    std::sort(rank.begin(), rank.end(), [&population](int a, int b) { return population[a].fitness < population[b].fitness; });
+}
+
+#endif
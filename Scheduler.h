@@ -0,0 +1,194 @@
+#ifndef SCHEDULER_H
+#define SCHEDULER_H
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#ifndef THREAD_NUM
+#define THREAD_NUM 0 // 调度器的工作线程数，0表示使用全部硬件线程
+#endif
+#ifndef NESTED_PARALLEL
+#define NESTED_PARALLEL 1 // 单次运行内部把种群更新等切分为子任务，供空闲线程窃取
+#endif
+
+// 工作窃取调度器，全部程序共用一组工作线程
+// 两类工作：
+//   作业（submit）：一次完整的运行，使用线程的thread_local状态，只由空闲的工作线程从全局队列领取
+//   子任务（parallelFor）：运行内部的一段计算，只通过引用使用所需的状态，不得读写thread_local状态
+// 每个工作线程有自己的子任务双端队列，自己从尾部取，其他线程从头部窃取
+// 等待子任务完成的线程只帮忙执行子任务，不领取作业，因此不会破坏正在进行的运行的thread_local状态
+class Scheduler {
+    public:
+        explicit Scheduler(int threadNum) {
+            if(threadNum < 1)
+                threadNum = 1;
+            this->signal.store(0);
+            this->stopping = false;
+            for(int t = 0; t <= threadNum; t++) // 最后一个队列供非工作线程提交子任务
+                queues.emplace_back(new SubTaskQueue());
+            for(int t = 0; t < threadNum; t++)
+                workers.emplace_back([this, t]() { workerLoop(t); });
+        }
+
+        ~Scheduler() {
+            {
+                std::lock_guard<std::mutex> lock(sleepMutex);
+                stopping = true;
+            }
+            wake.notify_all();
+            for(auto i = workers.begin(); i != workers.end(); i++)
+                (*i).join();
+        }
+
+        int size() const {
+            return workers.size();
+        }
+
+        // 提交一个作业，由空闲的工作线程按提交顺序领取
+        void submit(std::function<void()> job) {
+            {
+                std::lock_guard<std::mutex> lock(jobMutex);
+                jobs.emplace_back(std::move(job));
+            }
+            notify();
+        }
+
+        // job(begin, end)处理下标[begin, end)，切分为子任务，全部完成后返回
+        // 调用线程执行自己的子任务，完成后帮忙执行各队列中的其他子任务；没有可执行的子任务时休眠，直到本次最后一块完成时被唤醒
+        void parallelFor(int count, const std::function<void(int, int)>& job) {
+            int chunkNum = count < 2 * size() ? count : 2 * size();
+            if(! NESTED_PARALLEL || size() == 1 || chunkNum <= 1) {
+                job(0, count);
+                return;
+            }
+            int self = currentWorker();
+            if(self < 0)
+                self = workers.size();
+            std::atomic<int> pending(chunkNum);
+            {
+                std::lock_guard<std::mutex> lock(queues[self]->mutex);
+                for(int c = chunkNum - 1; c >= 0; c--) // 倒序压入，自己从尾部先取到第一块
+                    queues[self]->tasks.emplace_back(SubTask {&job, (int)((long long)count * c / chunkNum),
+                                                              (int)((long long)count * (c + 1) / chunkNum), &pending});
+            }
+            notify();
+            SubTask task;
+            while(true) {
+                long long seen = signal.load();
+                if(pending.load(std::memory_order_acquire) == 0)
+                    return;
+                if(popSubTask(self, task)) {
+                    run(task);
+                    continue;
+                }
+                // 剩余的块正由其他线程执行，等待新的子任务或本次完成；seen在检查pending之前读取，不会错过唤醒
+                std::unique_lock<std::mutex> lock(sleepMutex);
+                wake.wait(lock, [&]() { return signal.load() != seen; });
+            }
+        }
+
+    private:
+        struct SubTask {
+            const std::function<void(int, int)>* job;
+            int begin, end;
+            std::atomic<int>* pending; // 所属parallelFor尚未完成的块数
+        };
+        struct SubTaskQueue {
+            std::mutex mutex;
+            std::deque<SubTask> tasks;
+        };
+
+        std::vector<std::thread> workers;
+        std::vector<std::unique_ptr<SubTaskQueue>> queues; // 按工作线程
+        std::mutex jobMutex;
+        std::deque<std::function<void()>> jobs; // 全局作业队列
+        std::mutex sleepMutex;
+        std::condition_variable wake;
+        std::atomic<long long> signal; // 每次有新工作时加一，防止空闲线程错过唤醒
+        bool stopping;
+
+        // 当前线程的工作线程序号，非工作线程为-1
+        static int& currentWorker() {
+            static thread_local int index = -1;
+            return index;
+        }
+
+        void notify() {
+            signal.fetch_add(1);
+            std::lock_guard<std::mutex> lock(sleepMutex);
+            wake.notify_all();
+        }
+
+        void run(const SubTask& task) {
+            (*task.job)(task.begin, task.end);
+            if(task.pending->fetch_sub(1, std::memory_order_acq_rel) == 1) // 此后不得再访问task，等待方可能已返回
+                notify(); // 最后一块，唤醒休眠的等待方
+        }
+
+        // 先取自己队列的尾部，再从其他队列的头部窃取
+        bool popSubTask(int self, SubTask& task) {
+            {
+                std::lock_guard<std::mutex> lock(queues[self]->mutex);
+                if(! queues[self]->tasks.empty()) {
+                    task = queues[self]->tasks.back();
+                    queues[self]->tasks.pop_back();
+                    return true;
+                }
+            }
+            for(int k = 1; k < (int)queues.size(); k++) {
+                SubTaskQueue& victim = *queues[(self + k) % queues.size()];
+                std::lock_guard<std::mutex> lock(victim.mutex);
+                if(! victim.tasks.empty()) {
+                    task = victim.tasks.front();
+                    victim.tasks.pop_front();
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        bool popJob(std::function<void()>& job) {
+            std::lock_guard<std::mutex> lock(jobMutex);
+            if(jobs.empty())
+                return false;
+            job = std::move(jobs.front());
+            jobs.pop_front();
+            return true;
+        }
+
+        void workerLoop(int self) {
+            currentWorker() = self;
+            SubTask task;
+            std::function<void()> job;
+            while(true) {
+                long long seen = signal.load();
+                if(popSubTask(self, task)) {
+                    run(task);
+                    continue;
+                }
+                if(popJob(job)) {
+                    job();
+                    job = nullptr;
+                    continue;
+                }
+                std::unique_lock<std::mutex> lock(sleepMutex);
+                wake.wait(lock, [&]() { return stopping || signal.load() != seen; });
+                if(stopping)
+                    return;
+            }
+        }
+};
+
+// 全局调度器，首次使用时创建
+inline Scheduler& scheduler() {
+    static Scheduler instance(THREAD_NUM > 0 ? THREAD_NUM : std::thread::hardware_concurrency());
+    return instance;
+}
+
+#endif
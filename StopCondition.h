@@ -0,0 +1,93 @@
+#ifndef STOP_CONDITION_H
+#define STOP_CONDITION_H
+
+#include <chrono>
+#include <vector>
+
+#ifndef TIME_BUDGET_MS
+#define TIME_BUDGET_MS 0 // 单次求解的时间预算（毫秒），0表示不限
+#endif
+#ifndef STAGNATION_EPOCHS
+#define STAGNATION_EPOCHS 0 // 历史最佳连续多少代未改进即停止，0表示不限
+#endif
+#ifndef STOP_AT_BOUND
+#define STOP_AT_BOUND 1 // 历史最佳达到下界时停止
+#endif
+
+enum StopReason {
+    STOP_EPOCH, // 达到迭代次数
+    STOP_TIME, // 达到时间预算
+    STOP_STAGNATION, // 历史最佳停滞
+    STOP_BOUND // 历史最佳达到下界，已是最优
+};
+
+// 迭代停止条件，每代结束时检查，并记录停止原因和代数
+class StopCondition {
+    public:
+        StopReason reason;
+        int stopEpoch; // 停止时已完成的代数
+
+        StopCondition(double budgetMs, int stagnationEpochs, double lowerBound) {
+            this->budgetMs = budgetMs;
+            this->stagnationEpochs = stagnationEpochs;
+            this->lowerBound = lowerBound;
+            this->reason = STOP_EPOCH;
+            this->stopEpoch = 0;
+            this->startTime = std::chrono::steady_clock::now();
+        }
+
+        // epoch为已完成的代数，championFitnessRecord为历代最优值
+        bool shouldStop(int epoch, const std::vector<double>& championFitnessRecord) {
+            stopEpoch = epoch;
+            if(championFitnessRecord.empty())
+                return false;
+            double championFitness = championFitnessRecord.back();
+            if(atBound(championFitness)) {
+                reason = STOP_BOUND;
+                return true;
+            }
+            if(stagnationEpochs > 0 && championFitnessRecord.size() > stagnationEpochs
+                && championFitness >= championFitnessRecord.at(championFitnessRecord.size() - 1 - stagnationEpochs)) {
+                reason = STOP_STAGNATION;
+                return true;
+            }
+            if(budgetMs > 0 && elapsedMs() >= budgetMs) {
+                reason = STOP_TIME;
+                return true;
+            }
+            return false;
+        }
+
+        // 迭代前检查初始解，已达到下界时返回true，不必迭代
+        bool solvedAtStart(double championFitness) {
+            stopEpoch = 0;
+            if(! atBound(championFitness))
+                return false;
+            reason = STOP_BOUND;
+            return true;
+        }
+
+        double elapsedMs() const {
+            return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - startTime).count();
+        }
+
+        const char* reasonName() const {
+            switch(reason) {
+                case STOP_TIME: return "time";
+                case STOP_STAGNATION: return "stagnation";
+                case STOP_BOUND: return "bound";
+                default: return "epoch";
+            }
+        }
+
+    private:
+        double budgetMs, lowerBound;
+        int stagnationEpochs;
+        std::chrono::steady_clock::time_point startTime;
+
+        bool atBound(double championFitness) const {
+            return STOP_AT_BOUND && championFitness <= lowerBound * (1.0 + 1.0E-12); // 容许浮点误差
+        }
+};
+
+#endif
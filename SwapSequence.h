@@ -0,0 +1,124 @@
+#ifndef SWAP_SEQUENCE_H
+#define SWAP_SEQUENCE_H
+
+#include <random>
+#include <utility>
+#include <vector>
+
+// 模拟变换的序列及其逆索引，由调用方持有时跨调用复用，预留空间后不再分配内存
+struct SwapWorkspace {
+    std::vector<int> emul, position;
+
+    void reserve(int n) {
+        emul.reserve(n);
+        position.reserve(n);
+    }
+};
+
+// 由任务序列from变换到to的交换序列：依次对位置i，把to[i]当前所在的位置j（j >= i）与i交换
+// 维护任务id到位置的逆索引，每步O(1)找到j，整体O(n)；visit(i, j)按顺序接收每个交换（i != j）
+// from、to须为同一组任务id 0 ~ n-1的排列；from复制到workspace后模拟，调用期间可修改from
+template<class IndexT, class VisitT>
+void forEachSwap(const IndexT* from, const IndexT* to, int n, SwapWorkspace& workspace, VisitT visit) {
+    std::vector<int>& emul = workspace.emul;
+    std::vector<int>& position = workspace.position;
+    emul.assign(from, from + n);
+    position.resize(n);
+    for(int i=0; i<n; i++)
+        position[emul[i]] = i;
+    for(int i=0; i<n; i++) {
+        int j = position[to[i]];
+        if(i == j) // 在同一位置则不需要变化
+            continue;
+        visit(i, j);
+        std::swap(emul[i], emul[j]);
+        position[emul[i]] = i;
+        position[emul[j]] = j;
+    }
+}
+
+// 使用线程局部的workspace
+template<class IndexT, class VisitT>
+void forEachSwap(const IndexT* from, const IndexT* to, int n, VisitT visit) {
+    static thread_local SwapWorkspace workspace;
+    forEachSwap(from, to, n, workspace, visit);
+}
+
+// 计算交换序列，写入swapSequence，原有内容清空，已分配的空间复用
+template<class IndexT>
+void calcSwapSequence(const IndexT* from, const IndexT* to, int n, std::vector<std::pair<int, int>>& swapSequence) {
+    swapSequence.clear();
+    forEachSwap(from, to, n, [&swapSequence](int i, int j) { swapSequence.emplace_back(i, j); });
+}
+
+// 不生成交换序列，按顺序对每个交换以概率c调用apply(i, j)
+// 随机数的抽取顺序与先生成序列、再逐个判断时相同
+template<class IndexT, class RngT, class ApplyT>
+void applySwapSequence(const IndexT* from, const IndexT* to, int n, double c, RngT& rng, SwapWorkspace& workspace, ApplyT apply) {
+    std::uniform_real_distribution<double> rand_real(0.0, 1.0);
+    forEachSwap(from, to, n, workspace, [&](int i, int j) {
+        if(rand_real(rng) < c)
+            apply(i, j);
+    });
+}
+
+template<class IndexT, class RngT, class ApplyT>
+void applySwapSequence(const IndexT* from, const IndexT* to, int n, double c, RngT& rng, ApplyT apply) {
+    static thread_local SwapWorkspace workspace;
+    applySwapSequence(from, to, n, c, rng, workspace, apply);
+}
+
+// 交换序列缓冲区，容量在初始化时一次性分配，之后清空不分配内存
+// bounded为true时定长，追加不分配内存；否则已满时容量加倍，只在序列变长时偶尔分配
+class SwapBuffer {
+    public:
+        SwapBuffer() {
+            this->length = 0;
+            this->bounded = true;
+        }
+
+        void reserve(int capacity, bool bounded = true) {
+            swaps.resize(capacity);
+            length = 0;
+            this->bounded = bounded;
+        }
+
+        int size() const {
+            return length;
+        }
+        int capacity() const {
+            return swaps.size();
+        }
+        bool full() const {
+            return length == swaps.size();
+        }
+
+        void clear() {
+            length = 0;
+        }
+
+        // 定长且已满时不追加，返回false
+        bool push(int i, int j) {
+            if(full()) {
+                if(bounded)
+                    return false;
+                swaps.resize(2 * swaps.size() + 1);
+            }
+            swaps[length++] = std::pair<int, int>(i, j);
+            return true;
+        }
+
+        const std::pair<int, int>* begin() const {
+            return swaps.data();
+        }
+        const std::pair<int, int>* end() const {
+            return swaps.data() + length;
+        }
+
+    private:
+        std::vector<std::pair<int, int>> swaps;
+        int length;
+        bool bounded;
+};
+
+#endif
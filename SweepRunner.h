@@ -0,0 +1,108 @@
+#ifndef SWEEP_RUNNER_H
+#define SWEEP_RUNNER_H
+
+#include <string.h>
+#include <time.h>
+#include <atomic>
+#include <condition_variable>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <string>
+#include <vector>
+#include "Scheduler.h"
+
+// 一次运行
+struct SweepJob {
+    std::string taskNum; // 实例任务数量
+    std::string instanceId; // 实例编号
+    int repeat; // 重复测试次数
+    unsigned seed; // 本次运行的随机数种子
+};
+
+// 并行执行 任务数量 × 实例编号 × 重复次数 的全部运行
+// 各次运行互相独立，种子由baseSeed和运行序号导出，与线程数无关
+// 每次运行作为一个作业提交给调度器，记录行写入各自的槽位，由调用线程按原顺序汇总并输出日志，输出与串行执行时一致
+inline std::string runSweep(const std::vector<std::string>& iTN, const std::vector<std::string>& iID, int iRepeatTimes,
+                            unsigned baseSeed, std::function<std::string(const SweepJob&)> run) {
+    std::vector<SweepJob> jobs;
+    for(auto it_n = iTN.begin(); it_n != iTN.end(); it_n++) {
+        for(auto it_id = iID.begin(); it_id != iID.end(); it_id++) {
+            for(int i_r = 0; i_r < iRepeatTimes; i_r++) {
+                std::seed_seq seq {baseSeed, (unsigned)jobs.size()};
+                unsigned seed;
+                seq.generate(&seed, &seed + 1);
+                jobs.emplace_back(SweepJob {*it_n, *it_id, i_r, seed});
+            }
+        }
+    }
+
+    int jobNum = jobs.size();
+    std::vector<std::string> results(jobNum);
+    std::unique_ptr<std::atomic<bool>[]> completed(new std::atomic<bool>[jobNum]);
+    for(int k=0; k<jobNum; k++)
+        completed[k].store(false);
+    std::mutex writerMutex; // 保护completed的置位与汇总线程的检查，使通知不会丢失
+    std::condition_variable writerWake;
+
+    for(int k=0; k<jobNum; k++) {
+        scheduler().submit([&, k]() {
+            results[k] = run(jobs[k]);
+            // 持锁置位并通知：汇总线程只在持锁时检查，解锁之前不会返回，解锁后不再访问其栈上的对象
+            std::lock_guard<std::mutex> lock(writerMutex);
+            completed[k].store(true, std::memory_order_release);
+            writerWake.notify_one();
+        });
+    }
+
+    // 按顺序汇总
+    std::string resultReport = "";
+    for(int k=0; k<jobNum; k++) {
+        {
+            std::unique_lock<std::mutex> lock(writerMutex);
+            while(! completed[k].load(std::memory_order_acquire))
+                writerWake.wait(lock);
+        }
+        resultReport += results[k];
+        std::string().swap(results[k]);
+
+        // 控制台输出日志
+        time_t time_t_now = time(nullptr);
+        char* timeStamp = ctime(&time_t_now);
+        timeStamp[strlen(timeStamp) - 1] = 0;
+        std::cout << "[" << timeStamp <<"] ";
+        std::cout << "Completed Instance " + jobs[k].taskNum + "_" + jobs[k].instanceId + "_" + std::to_string(jobs[k].repeat) + ".\n";
+    }
+
+    return resultReport;
+}
+
+// 实例目录root中存在的任务数量，以第一个实例编号的文件是否存在判断
+inline std::vector<std::string> presentTaskNums(const std::string& root, const std::vector<std::string>& iTN, const std::vector<std::string>& iID) {
+    std::vector<std::string> present;
+    for(auto it_n = iTN.begin(); it_n != iTN.end(); it_n++) {
+        if(std::ifstream(root + "/" + *it_n + "/" + *it_n + "_" + iID.front() + ".txt"))
+            present.emplace_back(*it_n);
+    }
+    return present;
+}
+
+// 路径的最后一级名称，忽略末尾的'/'
+inline std::string baseName(std::string path) {
+    while(path.size() > 1 && path.back() == '/')
+        path.pop_back();
+    size_t slash = path.rfind('/');
+    return slash == std::string::npos ? path : path.substr(slash + 1);
+}
+
+// 文件路径的最后一级名称，去掉扩展名
+inline std::string stemName(const std::string& path) {
+    std::string name = baseName(path);
+    size_t dot = name.rfind('.');
+    return dot == std::string::npos || dot == 0 ? name : name.substr(0, dot);
+}
+
+#endif
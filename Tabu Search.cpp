@@ -0,0 +1,196 @@
+#include <iostream>
+#include <fstream>
+#include <assert.h>
+#include <vector>
+#include <string.h>
+#include <algorithm>
+#include <math.h>
+#include <time.h>
+#include <random>
+#include "Makespan.h"
+#include "MakespanTree.h"
+#include "LowerBound.h"
+#include "TabuList.h"
+#include "StopCondition.h"
+#include "SweepRunner.h"
+using namespace std;
+
+#define W 5000000.0 // 信道带宽（Hz）
+#define G0 -40 // 路径损耗常数（dB）
+#define THETA 4 // 路径损耗指数
+#define D0 1 // 参考距离（m）
+#define D 100 // 传输距离（m）
+#define N0 -174 // 噪声功率谱密度（dB * m / Hz）
+#define F 1.0E9 // 服务器CPU频率（Hz）
+
+#define ITERATIONS 400 // 迭代次数
+#define CANDIDATES 0.5 // 每次迭代评估的随机交换数（任务数的倍数）
+#define TENURE 10 // 禁忌期（迭代）
+#define POWER 5.0 // 发射功率（mW）
+
+// 单次运行的状态，各线程独立
+thread_local default_random_engine rand_eng(time(0)); // 随机数
+thread_local MakespanEvaluator evaluator; // 当前实例的makespan评估器
+string instanceRoot = "./TestInstances"; // 实例目录，由命令行参数指定，运行期间只读
+
+// 由发射功率计算任务传输速率
+double R(double power) {
+    return W * log(1 + 1.0E-12 * power / 3.981071705534985E-18 / W) / 0.6931471805599453;
+}
+
+class Task {
+    public:
+        int id;
+        double dataSize, cyclePerBit;
+
+        Task(int id, double dataSize, double cyclePerBit) {
+            this->id = id;
+            this->dataSize = dataSize;
+            this->cyclePerBit = cyclePerBit;
+        }
+};
+
+// 读取Instance文件，格式：id - dataSize - cyclePerBit
+vector<Task> readInstanceFile(string fileDir) {
+    vector<Task> taskList;
+    ifstream fileIn;
+    fileIn.open(fileDir);
+    assert(fileIn); // 已打开
+
+    int lineNum; fileIn >> lineNum;
+    for(int i=0; i<lineNum; i++) {
+        int id_t; double data_t, cycle_t;
+        fileIn >> id_t >> data_t >> cycle_t;
+        taskList.emplace_back( Task(id_t, data_t, cycle_t) );
+    }
+
+    fileIn.close();
+    return taskList;
+}
+
+// 随机取两个不同的位置
+pair<int, int> randomSwap(int n) {
+    uniform_int_distribution<int> rand_index(0, n - 1);
+    int i = rand_index(rand_eng), j = rand_index(rand_eng);
+    while(j == i)
+        j = rand_index(rand_eng);
+    return pair<int, int> (i, j);
+}
+
+// 单次运行，返回记录行
+string runInstance(const SweepJob& job) {
+    rand_eng.seed(job.seed); // 每次运行使用独立的随机数序列
+    string resultReport = "";
+
+    // 读取任务序列
+    vector<Task> taskList = readInstanceFile(instanceRoot + "/" + job.taskNum + "/" + job.taskNum + "_" + job.instanceId + ".txt");
+    evaluator.build(taskList, R(POWER), F); // 预计算传输时间和执行时间
+    LowerBound lowerBound(evaluator); // 实例的下界，只计算一次，用于提前停止和计算差距
+
+    // 记录历代最优值
+    vector<double> championFitnessRecord;
+
+    // 开始计时
+    struct timeval startTime;
+    mingw_gettimeofday(&startTime, NULL);
+    StopCondition stopCondition(TIME_BUDGET_MS, STAGNATION_EPOCHS, lowerBound.value); // 停止条件，每次迭代检查一次，达到下界即停止
+
+    // 随机初始解，由线段树维护makespan，每次评估交换O(log n)
+    int n = taskList.size();
+    shuffle(taskList.begin(), taskList.end(), rand_eng);
+    MakespanTree tree;
+    tree.build(evaluator, taskList);
+    double current = tree.makespan();
+    vector<int> championOrder(n); // 历史最佳的任务序列
+    for(int i=0; i<n; i++)
+        championOrder[i] = tree.taskAt(i);
+    double championFitness = current;
+    long long evaluations = 0, accepted = 0; // 评估和接受的移动数
+    TabuList tabuList;
+    tabuList.build(n, TENURE);
+    int candidateNum = (int)ceil(CANDIDATES * n);
+
+    // 禁忌搜索：每次迭代在随机候选交换中选出最好的允许移动，即使劣于当前解
+    // 交换位置i、j上的任务a、b后，TENURE次迭代内禁止a回到i、b回到j；优于历史最佳的移动不受禁忌限制
+    for(int iter = 0; iter < ITERATIONS && n > 1; iter++) {
+        pair<int, int> bestMove(-1, -1);
+        double bestFitness = HUGE_VAL;
+        for(int k = 0; k < candidateNum; k++) {
+            pair<int, int> s = randomSwap(n);
+            double fitness = tree.peekSwap(s.first, s.second);
+            evaluations++;
+            if(fitness >= bestFitness)
+                continue;
+            bool tabu = tabuList.isTabu(tree.taskAt(s.first), s.second, iter) || tabuList.isTabu(tree.taskAt(s.second), s.first, iter);
+            if(tabu && fitness >= championFitness)
+                continue;
+            bestMove = s;
+            bestFitness = fitness;
+        }
+        if(bestMove.first >= 0) {
+            int i = bestMove.first, j = bestMove.second;
+            tabuList.add(tree.taskAt(i), i, iter + TENURE, iter);
+            tabuList.add(tree.taskAt(j), j, iter + TENURE, iter);
+            tree.swap(i, j);
+            current = bestFitness;
+            accepted++;
+            if(current < championFitness) {
+                championFitness = current;
+                for(int p=0; p<n; p++)
+                    championOrder[p] = tree.taskAt(p);
+            }
+        }
+        championFitnessRecord.emplace_back(championFitness);
+
+        // 检查停止条件
+        if(stopCondition.shouldStop(iter + 1, championFitnessRecord))
+            break;
+    }
+    championFitness = evaluator.makespan(championOrder.data(), n); // 按任务序列重新计算，消除线段树的浮点误差
+
+    // 停止计时
+    struct timeval endTime;
+    mingw_gettimeofday(&endTime, NULL);
+    // 计算运行时间
+    double duration = (endTime.tv_sec - startTime.tv_sec)*1000.0 + (endTime.tv_usec - startTime.tv_usec)/1000.0;
+
+    // 记录信息
+    resultReport += job.taskNum + "\t"; // 任务数量
+    resultReport += job.instanceId + '\t'; // 测试实例编号
+    resultReport += to_string(job.repeat) + "\t"; // 重复测试次数
+    resultReport += to_string(championFitness) + "\t"; // 最优makespan
+    resultReport += to_string(duration) + "\t"; // 运行时间
+    resultReport += to_string(evaluations) + "\t"; // 评估的移动数
+    resultReport += to_string(accepted) + "\t"; // 接受的移动数
+    resultReport += to_string(lowerBound.value) + "\t"; // makespan的下界
+    resultReport += to_string(championFitness / lowerBound.value - 1.0) + "\t"; // 与下界的相对差距
+    resultReport += string(stopCondition.reasonName()) + "\t"; // 停止原因
+    resultReport += to_string(stopCondition.stopEpoch) + "\t"; // 停止时的迭代次数
+    resultReport += "\n";
+    return resultReport;
+}
+
+int main(int argc, char* argv[]) {
+    // 可选参数：实例目录，默认为./TestInstances
+    if(argc > 1)
+        instanceRoot = argv[1];
+
+// 实例测试
+vector<string> iTN {"10", "20", "30", "40", "50", "60", "70", "80", "90", "100"}; // 实例任务数量
+vector<string> iID {"0", "1", "2", "3", "4", "5", "6", "7", "8", "9"}; // 实例编号
+int iRepeatTimes = 5; // 每个实例重复次数
+
+    // 并行运行实例目录中存在的全部实例，按原顺序汇总
+    string resultReport = runSweep(presentTaskNums(instanceRoot, iTN, iID), iID, iRepeatTimes, time(0), runInstance);
+
+    // 写入输出文件，非默认实例目录时文件名注明目录
+    ofstream fileOut;
+    if(argc > 1)
+        fileOut.open("./Test Result - Tabu Search (" + baseName(instanceRoot) + ").txt");
+    else
+        fileOut.open("./Test Result - Tabu Search.txt");
+    fileOut << resultReport;
+    fileOut.close();
+
+    return 0;
+}
@@ -0,0 +1,93 @@
+#ifndef TABU_LIST_H
+#define TABU_LIST_H
+
+#include <assert.h>
+#include <stdint.h>
+#include <vector>
+
+// 禁忌表，记录“任务t不得回到位置p”直到某次迭代为止
+// 开放定址的哈希表，键为t * n + p + 1（0表示空槽位），值为禁忌的截止迭代
+// 过期的项不删除，插入同一键时覆盖；已用槽位超过一半时只保留未过期的项重建，查找和插入均摊O(1)
+class TabuList {
+    public:
+        TabuList() {
+            this->n = 0;
+            this->used = 0;
+            this->shift = 28;
+        }
+
+        // n为任务数，tenure为禁忌期；同时有效的项不超过2 * tenure个（每次移动记录两项）
+        void build(int n, int tenure) {
+            this->n = n;
+            int capacity = 16;
+            shift = 28;
+            while(capacity < 8 * tenure) {
+                capacity <<= 1;
+                shift--;
+            }
+            keys.assign(capacity, 0);
+            expiry.assign(capacity, 0);
+            used = 0;
+        }
+
+        // 第iteration次迭代时任务task是否不得放到位置pos
+        bool isTabu(int task, int pos, long long iteration) const {
+            uint32_t key = makeKey(task, pos);
+            for(int s = slot(key); keys[s] != 0; s = (s + 1) & (keys.size() - 1)) {
+                if(keys[s] == key)
+                    return expiry[s] > iteration;
+            }
+            return false;
+        }
+
+        // 禁止任务task回到位置pos，直到第until次迭代（不含）
+        void add(int task, int pos, long long until, long long iteration) {
+            if(2 * (used + 1) > keys.size())
+                purge(iteration);
+            uint32_t key = makeKey(task, pos);
+            int s = slot(key);
+            while(keys[s] != 0 && keys[s] != key)
+                s = (s + 1) & (keys.size() - 1);
+            if(keys[s] == 0)
+                used++;
+            keys[s] = key;
+            expiry[s] = until;
+        }
+
+    private:
+        std::vector<uint32_t> keys;
+        std::vector<long long> expiry;
+        std::vector<uint32_t> oldKeys; // 重建用，跨重建复用
+        std::vector<long long> oldExpiry;
+        int n, used;
+        int shift; // 32 - log2(容量)
+
+        uint32_t makeKey(int task, int pos) const {
+            assert(task >= 0 && task < n && pos >= 0 && pos < n);
+            return (uint32_t)task * n + pos + 1;
+        }
+        int slot(uint32_t key) const {
+            return (uint32_t)(key * 0x9E3779B1u) >> shift; // 乘法哈希取高位
+        }
+
+        // 丢弃过期的项并重新插入其余项，O(容量)
+        void purge(long long iteration) {
+            oldKeys.swap(keys);
+            oldExpiry.swap(expiry);
+            keys.assign(oldKeys.size(), 0);
+            expiry.assign(oldKeys.size(), 0);
+            used = 0;
+            for(int s = 0; s < oldKeys.size(); s++) {
+                if(oldKeys[s] == 0 || oldExpiry[s] <= iteration)
+                    continue;
+                int t = slot(oldKeys[s]);
+                while(keys[t] != 0)
+                    t = (t + 1) & (keys.size() - 1);
+                keys[t] = oldKeys[s];
+                expiry[t] = oldExpiry[s];
+                used++;
+            }
+        }
+};
+
+#endif